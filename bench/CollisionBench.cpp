@@ -0,0 +1,229 @@
+// Steps the spatial and collision systems without a window over a level's
+// colliders and a crowd of falling dynamic bodies, and writes the timings and
+// counts as JSON so they can be compared between commits
+//
+// usage: CollisionBench [resource dir] [level json] [bodies] [frames] [seed] [output json]
+
+
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "Loader/Loader.hpp"
+#include "Scene/Scene.hpp"
+#include "System/CollisionSystem.hpp"
+#include "System/SpatialSystem.hpp"
+#include "Component/SpatialComponents/SpatialComponent.hpp"
+#include "Component/SpatialComponents/PhysicsComponents.hpp"
+#include "Component/CollisionComponents/BounderComponent.hpp"
+
+
+
+namespace {
+
+constexpr float k_dt = 1.0f / 60.0f;
+constexpr unsigned int k_weight = 5;
+// same as the game's
+const glm::vec3 k_gravity(0.0f, -10.0f, 0.0f);
+const glm::vec3 k_octreeMin(-70.0f, -10.0f, -210.0f);
+const glm::vec3 k_octreeMax(70.0f, 50.0f, 40.0f);
+constexpr float k_octreeCellSize = 1.0f;
+// where bodies are dropped from
+const glm::vec3 k_spawnMin(-60.0f, 5.0f, -200.0f);
+const glm::vec3 k_spawnMax(60.0f, 40.0f, 30.0f);
+// every so often some bodies are kicked so the scene doesn't just settle
+constexpr int k_kickInterval = 30;
+constexpr float k_kickChance = 0.25f;
+constexpr float k_kickSpeed = 8.0f;
+
+std::mt19937 f_rand;
+
+float random(float min, float max) {
+    return std::uniform_real_distribution<float>(min, max)(f_rand);
+}
+
+glm::vec3 random(const glm::vec3 & min, const glm::vec3 & max) {
+    return glm::vec3(random(min.x, max.x), random(min.y, max.y), random(min.z, max.z));
+}
+
+// counts both the engine's allocate, which containers go through with rpmalloc,
+// and operator new, which they go through otherwise
+unsigned long long nAllocations() {
+    return detail::nAllocations;
+}
+
+struct Body {
+
+    NewtonianComponent * newtonian;
+
+};
+
+Body spawnBody(bool isCapsule) {
+    GameObject & obj(Scene::createGameObject());
+    Scene::addComponent<SpatialComponent>(obj, random(k_spawnMin, k_spawnMax));
+    if (isCapsule) {
+        Scene::addComponentAs<CapsuleBounderComponent, BounderComponent>(obj, k_weight, Capsule(glm::vec3(), 0.5f, 1.0f));
+    }
+    else {
+        Scene::addComponentAs<SphereBounderComponent, BounderComponent>(obj, k_weight, Sphere(glm::vec3(), random(0.25f, 1.0f)));
+    }
+    NewtonianComponent & newtonian(Scene::addComponent<NewtonianComponent>(obj, !isCapsule));
+    Scene::addComponentAs<GravityComponent, AcceleratorComponent>(obj);
+    newtonian.addVelocity(random(glm::vec3(-k_kickSpeed), glm::vec3(k_kickSpeed)));
+    return Body{ &newtonian };
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    return values[std::min(size_t(p * values.size()), values.size() - 1)];
+}
+
+double mean(const std::vector<double> & values) {
+    double sum(0.0);
+    for (double v : values) sum += v;
+    return values.empty() ? 0.0 : sum / values.size();
+}
+
+}
+
+
+
+void * operator new(std::size_t size) {
+    ++detail::nAllocations;
+    if (void * ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void * ptr) noexcept {
+    std::free(ptr);
+}
+
+
+
+int main(int argc, char ** argv) {
+    const char * resourceDir(argc > 1 ? argv[1] : "../resources/");
+    const char * level(argc > 2 ? argv[2] : "GameLevel_03.json");
+    int nBodies(argc > 3 ? std::atoi(argv[3]) : 500);
+    int nFrames(argc > 4 ? std::atoi(argv[4]) : 600);
+    unsigned int seed(argc > 5 ? unsigned(std::atoi(argv[5])) : 0);
+    const char * outPath(argc > 6 ? argv[6] : "CollisionBench.json");
+    f_rand.seed(seed);
+
+    Loader::init(false, resourceDir);
+    Loader::setHeadless(true);
+    Scene::initHeadless();
+    SpatialSystem::setGravity(k_gravity);
+
+    if (Loader::loadLevel(String(resourceDir) + level)) {
+        std::fprintf(stderr, "failed to load level %s%s\n", resourceDir, level);
+        return 1;
+    }
+    CollisionSystem::setOctree(k_octreeMin, k_octreeMax, k_octreeCellSize);
+
+    std::vector<Body> bodies;
+    for (int i(0); i < nBodies; ++i) {
+        bodies.push_back(spawnBody(i % 2 == 0));
+    }
+
+    // the first update adds everything, which isn't what's being measured
+    Scene::updateHeadless(k_dt);
+
+    std::vector<double> frameMs, collisionMs;
+    long long nPicks(0);
+    // per frame sums of the collision stats
+    double updateMs(0.0), treeMs(0.0), criticalMs(0.0), gatherMs(0.0), resolveMs(0.0);
+    long long nVisits(0), nCandidates(0), nPairs(0), nCachedPairs(0), nNarrowPhase(0), nHits(0), nAdjustments(0), nNetDeltas(0);
+    unsigned long long allocationsBefore(nAllocations());
+    for (int frame(0); frame < nFrames; ++frame) {
+        if (frame % k_kickInterval == 0) {
+            for (Body & body : bodies) {
+                if (random(0.0f, 1.0f) < k_kickChance) {
+                    glm::vec3 kick(random(glm::vec3(-k_kickSpeed, 0.0f, -k_kickSpeed), glm::vec3(k_kickSpeed)));
+                    body.newtonian->addVelocity(kick);
+                }
+            }
+        }
+
+        auto start(std::chrono::high_resolution_clock::now());
+        Scene::updateHeadless(k_dt);
+        frameMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+        collisionMs.push_back(Scene::collisionDT * 1000.0);
+        nPicks += CollisionSystem::s_nPicks;
+
+        const CollisionStats & stats(CollisionSystem::stats());
+        updateMs += stats.updateDT * 1000.0;
+        treeMs += stats.treeDT * 1000.0;
+        criticalMs += stats.criticalDT * 1000.0;
+        gatherMs += stats.gatherDT * 1000.0;
+        resolveMs += stats.resolveDT * 1000.0;
+        nVisits += stats.nRegionVisits + stats.nElementVisits + stats.nNearestRayVisits + stats.nAllRayVisits;
+        nCandidates += stats.nCandidates;
+        nPairs += stats.nPairs;
+        nCachedPairs += stats.nCachedPairs;
+        for (const auto & row : stats.nNarrowPhase) {
+            for (int n : row) nNarrowPhase += n;
+        }
+        nHits += stats.nHits;
+        nAdjustments += stats.nAdjustments;
+        nNetDeltas += stats.nNetDeltas;
+    }
+    unsigned long long nFrameAllocations(nAllocations() - allocationsBefore);
+
+    int nAsleep(0);
+    for (const BounderComponent * bounder : Scene::getComponents<BounderComponent>()) {
+        if (CollisionSystem::isAsleep(*bounder)) ++nAsleep;
+    }
+
+    std::printf(
+        "%d bodies, %d frames: %.3f ms/frame (p95 %.3f), collision %.3f ms/frame, %.1f picks, %.1f pairs, %.1f allocations per frame, %d asleep\n",
+        nBodies, nFrames,
+        mean(frameMs), percentile(frameMs, 0.95),
+        mean(collisionMs),
+        double(nPicks) / nFrames, double(nPairs) / nFrames, double(nFrameAllocations) / nFrames,
+        nAsleep
+    );
+
+    std::FILE * out(std::fopen(outPath, "w"));
+    if (!out) {
+        std::fprintf(stderr, "failed to open %s\n", outPath);
+        return 1;
+    }
+    std::fprintf(out, "{\n");
+    std::fprintf(out, "  \"level\": \"%s\",\n", level);
+    std::fprintf(out, "  \"bodies\": %d,\n", nBodies);
+    std::fprintf(out, "  \"frames\": %d,\n", nFrames);
+    std::fprintf(out, "  \"seed\": %u,\n", seed);
+    std::fprintf(out, "  \"bounders\": %d,\n", int(Scene::getComponents<BounderComponent>().size()));
+    std::fprintf(out, "  \"frameMs\": { \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"max\": %.4f },\n",
+        mean(frameMs), percentile(frameMs, 0.5), percentile(frameMs, 0.95), percentile(frameMs, 1.0));
+    std::fprintf(out, "  \"collisionMs\": { \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"max\": %.4f },\n",
+        mean(collisionMs), percentile(collisionMs, 0.5), percentile(collisionMs, 0.95), percentile(collisionMs, 1.0));
+    std::fprintf(out, "  \"phaseMs\": { \"update\": %.4f, \"tree\": %.4f, \"critical\": %.4f, \"gather\": %.4f, \"resolve\": %.4f },\n",
+        updateMs / nFrames, treeMs / nFrames, criticalMs / nFrames, gatherMs / nFrames, resolveMs / nFrames);
+    std::fprintf(out, "  \"picksPerFrame\": %.2f,\n", double(nPicks) / nFrames);
+    std::fprintf(out, "  \"octreeVisitsPerFrame\": %.2f,\n", double(nVisits) / nFrames);
+    std::fprintf(out, "  \"candidatesPerFrame\": %.2f,\n", double(nCandidates) / nFrames);
+    std::fprintf(out, "  \"pairsPerFrame\": %.2f,\n", double(nPairs) / nFrames);
+    std::fprintf(out, "  \"cachedPairsPerFrame\": %.2f,\n", double(nCachedPairs) / nFrames);
+    std::fprintf(out, "  \"narrowPhasePerFrame\": %.2f,\n", double(nNarrowPhase) / nFrames);
+    std::fprintf(out, "  \"hitsPerFrame\": %.2f,\n", double(nHits) / nFrames);
+    std::fprintf(out, "  \"adjustmentsPerFrame\": %.2f,\n", double(nAdjustments) / nFrames);
+    std::fprintf(out, "  \"netDeltasPerFrame\": %.2f,\n", double(nNetDeltas) / nFrames);
+    std::fprintf(out, "  \"allocationsPerFrame\": %.2f,\n", double(nFrameAllocations) / nFrames);
+    std::fprintf(out, "  \"asleep\": %d\n", nAsleep);
+    std::fprintf(out, "}\n");
+    std::fclose(out);
+
+    return 0;
+}
@@ -0,0 +1,201 @@
+// Compares the throughput of the single and batch versions of the shape tests
+// in Util/Geometry, and checks that they agree
+
+
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "Util/Geometry.hpp"
+
+
+
+namespace {
+
+constexpr int k_nShapes = 256;
+constexpr int k_nBatches = 256;
+constexpr int k_nReps = 16;
+constexpr float k_distE = 0.0001f;
+
+std::mt19937 f_rand(0);
+
+float random(float min, float max) {
+    return std::uniform_real_distribution<float>(min, max)(f_rand);
+}
+
+glm::vec3 randomPos() {
+    return glm::vec3(random(-5.0f, 5.0f), random(-5.0f, 5.0f), random(-5.0f, 5.0f));
+}
+
+AABox randomAABox() {
+    glm::vec3 pos(randomPos());
+    glm::vec3 ext(random(0.1f, 4.0f), random(0.1f, 4.0f), random(0.1f, 4.0f));
+    return AABox(pos - ext, pos + ext);
+}
+
+Sphere randomSphere() {
+    return Sphere(randomPos(), random(0.1f, 4.0f));
+}
+
+Capsule randomCapsule() {
+    return Capsule(randomPos(), random(0.1f, 2.0f), random(0.0f, 4.0f));
+}
+
+Ray randomRay() {
+    glm::vec3 dir(randomPos());
+    return Ray(randomPos(), dir / std::sqrt(glm::dot(dir, dir)));
+}
+
+template <typename Shape, typename Batch, typename F>
+void makeShapes(std::vector<Shape> & r_shapes, std::vector<Batch> & r_batches, const F & random) {
+    for (int i(0); i < k_nShapes; ++i) {
+        r_shapes.push_back(random());
+    }
+    for (int i(0); i < k_nBatches; ++i) {
+        Batch batch;
+        while (batch.n < k_geometryBatchSize) batch.add(random());
+        r_batches.push_back(batch);
+    }
+}
+
+double seconds(std::chrono::high_resolution_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void report(const char * name, double singleTime, double batchTime, int nMismatches, int nHits) {
+    double nTests(double(k_nReps) * k_nShapes * k_nBatches * k_geometryBatchSize);
+    std::printf(
+        "%-20s single %7.2f ns  batch %7.2f ns  speedup %5.2fx  hits %6.2f%%  %s\n",
+        name,
+        singleTime / nTests * 1.0e9,
+        batchTime / nTests * 1.0e9,
+        singleTime / batchTime,
+        100.0 * nHits / (nTests / k_nReps),
+        nMismatches ? "MISMATCH" : "ok"
+    );
+}
+
+// Tests every shape against every batch, first one lane at a time with single
+// and then a batch at a time
+template <typename Shape, typename Batch, typename F>
+int benchCollide(const char * name, const std::vector<Shape> & shapes, const std::vector<Batch> & batches, const F & single) {
+    std::vector<int> singleMasks(shapes.size() * batches.size()), batchMasks(singleMasks.size());
+
+    auto start(std::chrono::high_resolution_clock::now());
+    for (int rep(0); rep < k_nReps; ++rep) {
+        for (size_t i(0); i < shapes.size(); ++i) {
+            for (size_t j(0); j < batches.size(); ++j) {
+                int mask(0);
+                for (int k(0); k < batches[j].n; ++k) {
+                    if (single(shapes[i], batches[j][k])) mask |= 1 << k;
+                }
+                singleMasks[i * batches.size() + j] = mask;
+            }
+        }
+    }
+    double singleTime(seconds(start));
+
+    start = std::chrono::high_resolution_clock::now();
+    for (int rep(0); rep < k_nReps; ++rep) {
+        for (size_t i(0); i < shapes.size(); ++i) {
+            for (size_t j(0); j < batches.size(); ++j) {
+                batchMasks[i * batches.size() + j] = collide(shapes[i], batches[j]);
+            }
+        }
+    }
+    double batchTime(seconds(start));
+
+    int nMismatches(0), nHits(0);
+    for (size_t i(0); i < singleMasks.size(); ++i) {
+        if (singleMasks[i] != batchMasks[i]) ++nMismatches;
+        for (int k(0); k < k_geometryBatchSize; ++k) nHits += (singleMasks[i] >> k) & 1;
+    }
+    report(name, singleTime, batchTime, nMismatches, nHits);
+    return nMismatches;
+}
+
+template <typename Batch>
+int benchIntersect(const char * name, const std::vector<Ray> & rays, const std::vector<Batch> & batches) {
+    std::vector<float> singleDists(rays.size() * batches.size() * k_geometryBatchSize), batchDists(singleDists.size());
+    std::vector<int> singleMasks(rays.size() * batches.size()), batchMasks(singleMasks.size());
+
+    auto start(std::chrono::high_resolution_clock::now());
+    for (int rep(0); rep < k_nReps; ++rep) {
+        for (size_t i(0); i < rays.size(); ++i) {
+            for (size_t j(0); j < batches.size(); ++j) {
+                int mask(0);
+                float * dists(&singleDists[(i * batches.size() + j) * k_geometryBatchSize]);
+                for (int k(0); k < batches[j].n; ++k) {
+                    Intersect inter(intersect(rays[i], batches[j][k]));
+                    dists[k] = inter.dist;
+                    if (inter.is) mask |= 1 << k;
+                }
+                singleMasks[i * batches.size() + j] = mask;
+            }
+        }
+    }
+    double singleTime(seconds(start));
+
+    start = std::chrono::high_resolution_clock::now();
+    for (int rep(0); rep < k_nReps; ++rep) {
+        for (size_t i(0); i < rays.size(); ++i) {
+            for (size_t j(0); j < batches.size(); ++j) {
+                float * dists(&batchDists[(i * batches.size() + j) * k_geometryBatchSize]);
+                batchMasks[i * batches.size() + j] = intersect(rays[i], batches[j], dists);
+            }
+        }
+    }
+    double batchTime(seconds(start));
+
+    int nMismatches(0), nHits(0);
+    for (size_t i(0); i < singleMasks.size(); ++i) {
+        if (singleMasks[i] != batchMasks[i]) {
+            ++nMismatches;
+            continue;
+        }
+        for (int k(0); k < k_geometryBatchSize; ++k) {
+            if (!((singleMasks[i] >> k) & 1)) continue;
+            ++nHits;
+            float d1(singleDists[i * k_geometryBatchSize + k]), d2(batchDists[i * k_geometryBatchSize + k]);
+            if (std::abs(d1 - d2) > k_distE * std::max(1.0f, std::abs(d1))) ++nMismatches;
+        }
+    }
+    report(name, singleTime, batchTime, nMismatches, nHits);
+    return nMismatches;
+}
+
+}
+
+
+
+int main() {
+    std::vector<AABox> boxes; std::vector<AABoxBatch> boxBatches;
+    std::vector<Sphere> spheres; std::vector<SphereBatch> sphereBatches;
+    std::vector<Capsule> caps; std::vector<CapsuleBatch> capBatches;
+    std::vector<Ray> rays;
+    makeShapes(boxes, boxBatches, randomAABox);
+    makeShapes(spheres, sphereBatches, randomSphere);
+    makeShapes(caps, capBatches, randomCapsule);
+    for (int i(0); i < k_nShapes; ++i) {
+        rays.push_back(randomRay());
+    }
+
+    int nMismatches(0);
+    nMismatches += benchCollide("AABox-AABox", boxes, boxBatches, [](const AABox & a, const AABox & b) { return collide(a, b, nullptr); });
+    nMismatches += benchCollide("AABox-Sphere", boxes, sphereBatches, [](const AABox & a, const Sphere & b) { return collide(a, b, nullptr); });
+    nMismatches += benchCollide("AABox-Capsule", boxes, capBatches, [](const AABox & a, const Capsule & b) { return collide(a, b, nullptr); });
+    nMismatches += benchCollide("Sphere-AABox", spheres, boxBatches, [](const Sphere & a, const AABox & b) { return collide(b, a, nullptr); });
+    nMismatches += benchCollide("Sphere-Sphere", spheres, sphereBatches, [](const Sphere & a, const Sphere & b) { return collide(a, b, nullptr); });
+    nMismatches += benchCollide("Sphere-Capsule", spheres, capBatches, [](const Sphere & a, const Capsule & b) { return collide(a, b, nullptr); });
+    nMismatches += benchCollide("Capsule-AABox", caps, boxBatches, [](const Capsule & a, const AABox & b) { return collide(b, a, nullptr); });
+    nMismatches += benchCollide("Capsule-Sphere", caps, sphereBatches, [](const Capsule & a, const Sphere & b) { return collide(b, a, nullptr); });
+    nMismatches += benchCollide("Capsule-Capsule", caps, capBatches, [](const Capsule & a, const Capsule & b) { return collide(a, b, nullptr); });
+    nMismatches += benchIntersect("Ray-AABox", rays, boxBatches);
+    nMismatches += benchIntersect("Ray-Sphere", rays, sphereBatches);
+    nMismatches += benchIntersect("Ray-Capsule", rays, capBatches);
+
+    return nMismatches ? 1 : 0;
+}
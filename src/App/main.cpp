@@ -30,6 +30,12 @@ void printUsage() {
 
     std::cout << "\t-m <file_name>" << std::endl;
     std::cout << "\t\tCreate graph representation of the map, filename of said graph" << std::endl;
+
+    std::cout << "\t-s <steps_per_second>" << std::endl;
+    std::cout << "\t\tSet the simulation rate, 60 by default" << std::endl;
+
+    std::cout << "\t-p" << std::endl;
+    std::cout << "\t\tSimulate on a separate thread while the previous frame is drawn" << std::endl;
 }
 
 int parseArgs(int argc, char **argv) {
@@ -70,6 +76,19 @@ int parseArgs(int argc, char **argv) {
             Scene::mapFilename = argv[i + 1];
             Scene::mapping = true;
         }
+
+        /* Set simulation rate */
+        if (!strcmp(argv[i], "-s")) {
+            if (i + 1 >= argc || atoi(argv[i + 1]) <= 0) {
+                printUsage();
+                return 1;
+            }
+            EngineApp::simRate = atoi(argv[i + 1]);
+        }
+        /* Pipeline simulation and rendering */
+        if (!strcmp(argv[i], "-p")) {
+            EngineApp::pipelined = true;
+        }
     }
     return 0;
 }
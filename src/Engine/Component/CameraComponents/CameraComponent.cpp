@@ -24,6 +24,7 @@ CameraComponent::CameraComponent(GameObject & gameObject, float fov, float near,
     m_projMat(),
     m_viewMatValid(false),
     m_projMatValid(false),
+    m_viewInterpP(1.0f),
     m_frustumValid(false)
 {}
 
@@ -40,6 +41,7 @@ CameraComponent::CameraComponent(GameObject & gameObject, glm::vec2 horiz, glm::
     m_projMat(),
     m_viewMatValid(false),
     m_projMatValid(false),
+    m_viewInterpP(1.0f),
     m_frustumValid(false)
 {}
 
@@ -54,6 +56,14 @@ void CameraComponent::init() {
     });
     Scene::addReceiver<SpatialChangeMessage>(&gameObject(), spatChangeCallback);
     Scene::addReceiver<CollisionAdjustMessage>(&gameObject(), spatChangeCallback); // necessary as collision sets position silently
+    // physics also moves silently, and says so once for every body
+    auto spatsMovedCallback([&](const Message & msg_) {
+        if (m_spatial->isChange()) {
+            m_viewMatValid = false;
+            m_frustumValid = false;
+        }
+    });
+    Scene::addReceiver<SpatialsMovedMessage>(nullptr, spatsMovedCallback);
 
     if (!m_isOrtho) {
         auto windowSizeCallback([&] (const Message & msg_) {
@@ -93,7 +103,7 @@ float distToPlane(const glm::vec4 & plane, const glm::vec3 & p) {
 }
 
 const bool CameraComponent::sphereInFrustum(const Sphere & sphere) const {
-    if (!m_frustumValid) detFrustum();
+    if (!m_frustumValid || m_viewInterpP != RenderSystem::interpP()) detFrustum();
 
     if (distToPlane(m_frustumLeft,   sphere.origin) < -sphere.radius) return false;
     if (distToPlane(m_frustumRight,  sphere.origin) < -sphere.radius) return false;
@@ -110,7 +120,7 @@ glm::vec3 CameraComponent::getLookDir() const {
 };
 
 const glm::mat4 & CameraComponent::getView() const {
-    if (!m_viewMatValid) detView();
+    if (!m_viewMatValid || m_viewInterpP != RenderSystem::interpP()) detView();
     return m_viewMat;
 }
 
@@ -119,9 +129,14 @@ const glm::mat4 & CameraComponent::getProj() const {
     return m_projMat;
 }
 
+// the view is interpolated the same as everything rendered with it
 void CameraComponent::detView() const {
-    m_viewMat = Util::viewMatrix(m_spatial->position(), m_spatial->u(), m_spatial->v(), m_spatial->w());
+    m_viewInterpP = RenderSystem::interpP();
+    glm::vec3 u(glm::normalize(m_spatial->u(m_viewInterpP)));
+    glm::vec3 w(glm::normalize(m_spatial->w(m_viewInterpP)));
+    m_viewMat = Util::viewMatrix(m_spatial->position(m_viewInterpP), u, glm::cross(w, u), w);
     m_viewMatValid = true;
+    m_frustumValid = false;
 }
 
 void CameraComponent::detProj() const {
@@ -78,6 +78,7 @@ class CameraComponent : public Component {
         mutable glm::mat4 m_projMat;
         mutable bool m_viewMatValid;
         mutable bool m_projMatValid;
+        mutable float m_viewInterpP; // render interpolation the view was determined for
         
         mutable glm::vec4 m_frustumLeft;
         mutable glm::vec4 m_frustumRight;
@@ -6,14 +6,161 @@
 #include "glm/gtx/norm.hpp"
 
 #include "Component/SpatialComponents/SpatialComponent.hpp"
+#include "Model/Mesh.hpp"
+#include "System/CollisionSystem.hpp"
+#include "Util/Util.hpp"
 
 
 
-BounderComponent::BounderComponent(GameObject & gameObject, unsigned int weight, const SpatialComponent * spatial) :
+namespace {
+
+unsigned int f_nextID(0);
+
+template <typename T> const T & as(const BounderShape & shape);
+template <> const AABox & as<AABox>(const BounderShape & shape) { return shape.box; }
+template <> const Sphere & as<Sphere>(const BounderShape & shape) { return shape.sphere; }
+template <> const Capsule & as<Capsule>(const BounderShape & shape) { return shape.capsule; }
+
+// what each shape is swept as against a mesh. Boxes are swept as their
+// enclosing sphere
+Sphere sweptShape(const AABox & box) { return Sphere(box.center(), glm::length(box.max - box.center())); }
+const Sphere & sweptShape(const Sphere & sphere) { return sphere; }
+const Capsule & sweptShape(const Capsule & cap) { return cap; }
+
+template <typename T1, typename T2>
+bool collideAs(const BounderShape & shape1, const BounderShape & shape2, glm::vec3 * delta) {
+    return ::collide(as<T1>(shape1), as<T2>(shape2), delta);
+}
+
+// Geometry only has one order of each mixed pair, so the other is flipped
+template <typename T1, typename T2>
+bool collideFlipped(const BounderShape & shape1, const BounderShape & shape2, glm::vec3 * delta) {
+    bool res(::collide(as<T2>(shape2), as<T1>(shape1), delta));
+    if (delta) *delta *= -1.0f;
+    return res;
+}
+
+template <typename T>
+bool collideMesh(const BounderShape & shape1, const BounderShape & shape2, glm::vec3 * delta) {
+    return shape2.mesh->collide(as<T>(shape1), delta);
+}
+
+template <typename T>
+bool collideMeshFlipped(const BounderShape & shape1, const BounderShape & shape2, glm::vec3 * delta) {
+    bool res(shape1.mesh->collide(as<T>(shape2), delta));
+    if (delta) *delta *= -1.0f;
+    return res;
+}
+
+// meshes are static, so never collide with each other
+bool collideMeshes(const BounderShape & shape1, const BounderShape & shape2, glm::vec3 * delta) {
+    return false;
+}
+
+template <typename T1, typename T2>
+Intersect sweepAs(const BounderShape & shape1, const glm::vec3 & dir, const BounderShape & shape2) {
+    return ::sweep(as<T1>(shape1), dir, as<T2>(shape2));
+}
+
+template <typename T>
+Intersect sweepMesh(const BounderShape & shape1, const glm::vec3 & dir, const BounderShape & shape2) {
+    return shape2.mesh->sweep(sweptShape(as<T>(shape1)), dir);
+}
+
+// a mesh is swept as its enclosing box
+template <typename T>
+Intersect sweepFromMesh(const BounderShape & shape1, const glm::vec3 & dir, const BounderShape & shape2) {
+    return ::sweep(shape1.box, dir, as<T>(shape2));
+}
+
+using CollideFunc = bool (*)(const BounderShape &, const BounderShape &, glm::vec3 *);
+using SweepFunc = Intersect (*)(const BounderShape &, const glm::vec3 &, const BounderShape &);
+
+// indexed by [type1][type2]
+const CollideFunc k_collideFuncs[BounderShape::k_nTypes][BounderShape::k_nTypes]{
+    { collideAs<AABox, AABox>, collideAs<AABox, Sphere>, collideAs<AABox, Capsule>, collideMesh<AABox> },
+    { collideFlipped<Sphere, AABox>, collideAs<Sphere, Sphere>, collideAs<Sphere, Capsule>, collideMesh<Sphere> },
+    { collideFlipped<Capsule, AABox>, collideFlipped<Capsule, Sphere>, collideAs<Capsule, Capsule>, collideMesh<Capsule> },
+    { collideMeshFlipped<AABox>, collideMeshFlipped<Sphere>, collideMeshFlipped<Capsule>, collideMeshes }
+};
+
+const SweepFunc k_sweepFuncs[BounderShape::k_nTypes][BounderShape::k_nTypes]{
+    { sweepAs<AABox, AABox>, sweepAs<AABox, Sphere>, sweepAs<AABox, Capsule>, sweepMesh<AABox> },
+    { sweepAs<Sphere, AABox>, sweepAs<Sphere, Sphere>, sweepAs<Sphere, Capsule>, sweepMesh<Sphere> },
+    { sweepAs<Capsule, AABox>, sweepAs<Capsule, Sphere>, sweepAs<Capsule, Capsule>, sweepMesh<Capsule> },
+    { sweepFromMesh<AABox>, sweepFromMesh<Sphere>, sweepFromMesh<Capsule>, sweepFromMesh<AABox> }
+};
+
+}
+
+
+
+constexpr int BounderShape::k_nTypes;
+
+AABox BounderShape::enclosingAABox() const {
+    switch (type) {
+        case Type::aabox:
+        case Type::mesh:
+            return box;
+        case Type::sphere:
+            return AABox(sphere.origin - sphere.radius, sphere.origin + sphere.radius);
+        case Type::capsule:
+            return AABox(
+                glm::vec3(
+                    capsule.center.x - capsule.radius,
+                    capsule.center.y - capsule.height * 0.5f - capsule.radius,
+                    capsule.center.z - capsule.radius
+                ),
+                glm::vec3(
+                    capsule.center.x + capsule.radius,
+                    capsule.center.y + capsule.height * 0.5f + capsule.radius,
+                    capsule.center.z + capsule.radius
+                )
+            );
+    }
+    return AABox();
+}
+
+bool collide(const BounderShape & shape1, const BounderShape & shape2, glm::vec3 * delta) {
+    return k_collideFuncs[int(shape1.type)][int(shape2.type)](shape1, shape2, delta);
+}
+
+Intersect intersect(const Ray & ray, const BounderShape & shape) {
+    switch (shape.type) {
+        case BounderShape::Type::aabox: return ::intersect(ray, shape.box);
+        case BounderShape::Type::sphere: return ::intersect(ray, shape.sphere);
+        case BounderShape::Type::capsule: return ::intersect(ray, shape.capsule);
+        case BounderShape::Type::mesh: return shape.mesh->intersect(ray);
+    }
+    return Intersect();
+}
+
+Intersect sweep(const BounderShape & shape1, const glm::vec3 & dir, const BounderShape & shape2) {
+    return k_sweepFuncs[int(shape1.type)][int(shape2.type)](shape1, dir, shape2);
+}
+
+
+
+constexpr unsigned int BounderComponent::k_staticLayer;
+constexpr unsigned int BounderComponent::k_dynamicLayer;
+constexpr unsigned int BounderComponent::k_playerLayer;
+constexpr unsigned int BounderComponent::k_enemyLayer;
+constexpr unsigned int BounderComponent::k_projectileLayer;
+constexpr unsigned int BounderComponent::k_triggerLayer;
+constexpr unsigned int BounderComponent::k_allLayers;
+
+BounderComponent::BounderComponent(GameObject & gameObject, unsigned int weight, BounderShape::Type shapeType, const SpatialComponent * spatial) :
     Component(gameObject),
     m_spatial(spatial),
+    m_id(f_nextID++),
+    m_index(-1),
     m_weight(weight),
-    m_isChange(false)
+    m_shapeType(shapeType),
+    m_layer(weight == UINT_MAX ? k_staticLayer : weight == 0 ? k_triggerLayer : k_dynamicLayer),
+    m_mask(weight == UINT_MAX ? k_allLayers & ~k_staticLayer : k_allLayers),
+    m_isChange(false),
+    m_restBox(),
+    m_restFrames(0)
 {}
 
 void BounderComponent::init() {
@@ -21,6 +168,44 @@ void BounderComponent::init() {
     else assert(m_spatial = gameObject().getSpatial());
 }
 
+bool BounderComponent::collide(const BounderComponent & o, glm::vec3 * delta) const {
+    return ::collide(transShape(), o.transShape(), delta);
+}
+
+Intersect BounderComponent::sweep(const BounderComponent & o) const {
+    glm::vec3 dir(Util::safeNorm(center() - prevCenter()));
+    if (dir == glm::vec3()) {
+        return Intersect();
+    }
+    return ::sweep(prevTransShape(), dir, o.transShape());
+}
+
+BounderShape BounderComponent::transShape() const {
+    switch (m_shapeType) {
+        case BounderShape::Type::aabox: return BounderShape(static_cast<const AABBounderComponent &>(*this).transBox());
+        case BounderShape::Type::sphere: return BounderShape(static_cast<const SphereBounderComponent &>(*this).transSphere());
+        case BounderShape::Type::capsule: return BounderShape(static_cast<const CapsuleBounderComponent &>(*this).transCapsule());
+        case BounderShape::Type::mesh: return BounderShape(static_cast<const MeshBounderComponent &>(*this).bvh());
+    }
+    return BounderShape();
+}
+
+BounderShape BounderComponent::prevTransShape() const {
+    switch (m_shapeType) {
+        case BounderShape::Type::aabox: return BounderShape(static_cast<const AABBounderComponent &>(*this).prevTransBox());
+        case BounderShape::Type::sphere: return BounderShape(static_cast<const SphereBounderComponent &>(*this).prevTransSphere());
+        case BounderShape::Type::capsule: return BounderShape(static_cast<const CapsuleBounderComponent &>(*this).prevTransCapsule());
+        case BounderShape::Type::mesh: return BounderShape(static_cast<const MeshBounderComponent &>(*this).bvh());
+    }
+    return BounderShape();
+}
+
+void BounderComponent::setLayer(unsigned int layer, unsigned int mask) {
+    m_layer = layer;
+    m_mask = mask;
+    CollisionSystem::layerChanged(*this);
+}
+
 
 
 AABox AABBounderComponent::transformAABox(const AABox & box, const glm::mat4 & transMat) {
@@ -54,7 +239,7 @@ AABox AABBounderComponent::transformAABox(const AABox & box, const glm::vec3 & p
 }
 
 AABBounderComponent::AABBounderComponent(GameObject & gameObject, unsigned int weight, const AABox & box, const SpatialComponent * spatial) :
-    BounderComponent(gameObject, weight, spatial),
+    BounderComponent(gameObject, weight, BounderShape::Type::aabox, spatial),
     m_box(box),
     m_transBox(m_box),
     m_prevTransBox(m_transBox)
@@ -73,16 +258,6 @@ void AABBounderComponent::update(float dt) {
         m_transBox;
 }
 
-bool AABBounderComponent::collide(const BounderComponent & o, glm::vec3 * delta) const {
-    if (dynamic_cast<const AABBounderComponent *>(&o)) 
-        return ::collide(transBox(), static_cast<const AABBounderComponent &>(o).transBox(), delta);
-    else if (dynamic_cast<const SphereBounderComponent *>(&o))
-        return ::collide(transBox(), static_cast<const SphereBounderComponent &>(o).transSphere(), delta);
-    else if (dynamic_cast<const CapsuleBounderComponent *>(&o))
-        return ::collide(transBox(), static_cast<const CapsuleBounderComponent &>(o).transCapsule(), delta);
-    return false;
-}
-
 Intersect AABBounderComponent::intersect(const Ray & ray) const {
     return ::intersect(ray, m_transBox);
 }
@@ -121,7 +296,7 @@ Sphere SphereBounderComponent::transformSphere(const Sphere & sphere, const glm:
 }
 
 SphereBounderComponent::SphereBounderComponent(GameObject & gameObject, unsigned int weight, const Sphere & sphere, const SpatialComponent * spatial) :
-    BounderComponent(gameObject, weight, spatial),
+    BounderComponent(gameObject, weight, BounderShape::Type::sphere, spatial),
     m_sphere(sphere),
     m_transSphere(m_sphere),
     m_prevTransSphere(m_transSphere)
@@ -134,25 +309,12 @@ void SphereBounderComponent::update(float dt) {
     m_prevTransSphere = m_isChange ? transformSphere(m_sphere, m_spatial->prevModelMatrix(), m_spatial->prevScale()) : m_transSphere;
 }
 
-bool SphereBounderComponent::collide(const BounderComponent & o, glm::vec3 * delta) const {
-    if (dynamic_cast<const AABBounderComponent *>(&o)) {
-        bool res(::collide(static_cast<const AABBounderComponent &>(o).transBox(), transSphere(), delta));
-        if (delta) *delta *= -1.0f;
-        return res;
-    }
-    else if (dynamic_cast<const SphereBounderComponent *>(&o))
-        return ::collide(transSphere(), static_cast<const SphereBounderComponent &>(o).transSphere(), delta);
-    else if (dynamic_cast<const CapsuleBounderComponent *>(&o))
-        return ::collide(transSphere(), static_cast<const CapsuleBounderComponent &>(o).transCapsule(), delta);
-    return false;
-}
-
 Intersect SphereBounderComponent::intersect(const Ray & ray) const {
     return ::intersect(ray, m_transSphere);
 }
 
 AABox SphereBounderComponent::enclosingAABox() const {
-    return AABox(m_transSphere.origin - m_transSphere.radius, m_transSphere.origin + m_transSphere.radius);
+    return BounderShape(m_transSphere).enclosingAABox();
 }
 
 Sphere SphereBounderComponent::enclosingSphere() const {
@@ -183,7 +345,7 @@ Capsule CapsuleBounderComponent::transformCapsule(const Capsule & capsule, const
 }
 
 CapsuleBounderComponent::CapsuleBounderComponent(GameObject & gameObject, unsigned int weight, const Capsule & capsule, const SpatialComponent * spatial) :
-    BounderComponent(gameObject, weight, spatial),
+    BounderComponent(gameObject, weight, BounderShape::Type::capsule, spatial),
     m_capsule(capsule),
     m_transCapsule(m_capsule),
     m_prevTransCapsule(m_transCapsule)
@@ -196,39 +358,12 @@ void CapsuleBounderComponent::update(float dt) {
     m_prevTransCapsule = m_isChange ? transformCapsule(m_capsule, m_spatial->prevModelMatrix(), m_spatial->prevScale()) : m_transCapsule;
 }
 
-bool CapsuleBounderComponent::collide(const BounderComponent & o, glm::vec3 * delta) const {
-    if (dynamic_cast<const AABBounderComponent *>(&o)) {
-        bool res(::collide(static_cast<const AABBounderComponent &>(o).transBox(), transCapsule(), delta));
-        if (delta) *delta *= -1.0f;
-        return res;
-    }
-    else if (dynamic_cast<const SphereBounderComponent *>(&o)) {
-        bool res(::collide(static_cast<const SphereBounderComponent &>(o).transSphere(), transCapsule(), delta));
-        if (delta) *delta *= -1.0f;
-        return res;
-    }
-    else if (dynamic_cast<const CapsuleBounderComponent *>(&o))
-        return ::collide(transCapsule(), static_cast<const CapsuleBounderComponent &>(o).transCapsule(), delta);
-    return false;
-}
-
 Intersect CapsuleBounderComponent::intersect(const Ray & ray) const {
     return ::intersect(ray, m_transCapsule);
 }
 
 AABox CapsuleBounderComponent::enclosingAABox() const {
-    return AABox(
-        glm::vec3(
-            m_transCapsule.center.x - m_transCapsule.radius,
-            m_transCapsule.center.y - m_transCapsule.height * 0.5f - m_transCapsule.radius,
-            m_transCapsule.center.z - m_transCapsule.radius
-        ),
-        glm::vec3(
-            m_transCapsule.center.x + m_transCapsule.radius,
-            m_transCapsule.center.y + m_transCapsule.height * 0.5f + m_transCapsule.radius,
-            m_transCapsule.center.z + m_transCapsule.radius
-        )
-    );
+    return BounderShape(m_transCapsule).enclosingAABox();
 }
 
 Sphere CapsuleBounderComponent::enclosingSphere() const {
@@ -257,4 +392,61 @@ bool CapsuleBounderComponent::isCritical() const {
 
 glm::vec3 CapsuleBounderComponent::groundPosition() const {
     return glm::vec3(m_transCapsule.center.x, m_transCapsule.center.y - m_transCapsule.height * 0.5f - m_transCapsule.radius, m_transCapsule.center.z);
-}
\ No newline at end of file
+}
+
+
+
+MeshBounderComponent::MeshBounderComponent(GameObject & gameObject, unsigned int weight, const Mesh & mesh, const SpatialComponent * spatial) :
+    BounderComponent(gameObject, weight, BounderShape::Type::mesh, spatial),
+    m_mesh(mesh),
+    m_bvh(),
+    m_prevBox(),
+    m_isBuilt(false)
+{}
+
+void MeshBounderComponent::update(float dt) {
+    m_isChange = m_spatial->isChange();
+    if (m_isBuilt && !m_isChange) {
+        m_prevBox = m_bvh.box();
+        return;
+    }
+    AABox prevBox(m_bvh.box());
+
+    static Vector<Triangle> s_triangles;
+    const Vector<float> & vertBuf(m_mesh.buffers.vertBuf);
+    const Vector<unsigned int> & eleBuf(m_mesh.buffers.eleBuf);
+    const glm::mat4 & modelMat(m_spatial->modelMatrix());
+    auto vert([&](unsigned int i) {
+        return glm::vec3(modelMat * glm::vec4(vertBuf[3 * i + 0], vertBuf[3 * i + 1], vertBuf[3 * i + 2], 1.0f));
+    });
+    s_triangles.clear();
+    // unindexed meshes are consecutive triples of vertices
+    int nIndices(eleBuf.empty() ? int(vertBuf.size()) / 3 : int(eleBuf.size()));
+    for (int i(0); i + 2 < nIndices; i += 3) {
+        if (eleBuf.empty()) s_triangles.emplace_back(vert(i), vert(i + 1), vert(i + 2));
+        else s_triangles.emplace_back(vert(eleBuf[i]), vert(eleBuf[i + 1]), vert(eleBuf[i + 2]));
+    }
+    m_bvh.build(s_triangles);
+
+    m_prevBox = m_isBuilt ? prevBox : m_bvh.box();
+    m_isBuilt = true;
+}
+
+Intersect MeshBounderComponent::intersect(const Ray & ray) const {
+    return m_bvh.intersect(ray);
+}
+
+AABox MeshBounderComponent::enclosingAABox() const {
+    return m_bvh.box();
+}
+
+Sphere MeshBounderComponent::enclosingSphere() const {
+    AABox box(m_bvh.box());
+    glm::vec3 center(box.center());
+    return Sphere(center, glm::length(box.max - center));
+}
+
+glm::vec3 MeshBounderComponent::groundPosition() const {
+    AABox box(m_bvh.box());
+    return glm::vec3((box.min.x + box.max.x) * 0.5f, box.min.y, (box.min.z + box.max.z) * 0.5f);
+}
@@ -4,6 +4,7 @@
 
 #include "Component/Component.hpp"
 #include "Util/Geometry.hpp"
+#include "Util/MeshBVH.hpp"
 
 
 
@@ -15,15 +16,83 @@ class Mesh;
 
 
 
+// A bounder's transformed shape by value, tagged with its type. Only the
+// shape of that type is held, overlapping the others, so the arrays of them
+// the collision system keeps carry no dead shapes. Pairs of shapes are
+// dispatched through tables indexed by type rather than through virtual
+// calls and casts
+struct BounderShape {
+
+    enum class Type { aabox, sphere, capsule, mesh };
+    static constexpr int k_nTypes = 4;
+
+    Type type;
+    union {
+        AABox box; // also the enclosing box of a mesh
+        Sphere sphere;
+        Capsule capsule;
+    };
+    const MeshBVH * mesh; // owned by the bounder, only set for a mesh
+
+    BounderShape() :
+        type(Type::aabox),
+        box(), mesh(nullptr)
+    {}
+
+    explicit BounderShape(const AABox & box) :
+        type(Type::aabox),
+        box(box), mesh(nullptr)
+    {}
+
+    explicit BounderShape(const Sphere & sphere) :
+        type(Type::sphere),
+        sphere(sphere), mesh(nullptr)
+    {}
+
+    explicit BounderShape(const Capsule & capsule) :
+        type(Type::capsule),
+        capsule(capsule), mesh(nullptr)
+    {}
+
+    explicit BounderShape(const MeshBVH & mesh) :
+        type(Type::mesh),
+        box(mesh.box()), mesh(&mesh)
+    {}
+
+    AABox enclosingAABox() const;
+
+};
+
+// The same as the single shape versions in Util/Geometry, for any pair of types
+bool collide(const BounderShape & shape1, const BounderShape & shape2, glm::vec3 * delta);
+Intersect intersect(const Ray & ray, const BounderShape & shape);
+Intersect sweep(const BounderShape & shape1, const glm::vec3 & dir, const BounderShape & shape2);
+
+
+
 // Represents a bounding surface around an entity
 class BounderComponent : public Component {
 
     friend Scene;
     friend CollisionSystem;
 
+    public:
+
+    // Collision layers. A bounder is on one layer and only collides with
+    // bounders on layers in its mask, and vice versa
+    static constexpr unsigned int k_staticLayer = 1 << 0;
+    static constexpr unsigned int k_dynamicLayer = 1 << 1;
+    static constexpr unsigned int k_playerLayer = 1 << 2;
+    static constexpr unsigned int k_enemyLayer = 1 << 3;
+    static constexpr unsigned int k_projectileLayer = 1 << 4;
+    static constexpr unsigned int k_triggerLayer = 1 << 5;
+    static constexpr unsigned int k_allLayers = ~0u;
+
     protected: // only scene or friends can create component
 
-    BounderComponent(GameObject & gameObject, unsigned int weight, const SpatialComponent * spatial = nullptr);
+    // Static bounders (weight UINT_MAX) default to the static layer and don't
+    // collide with each other. Weightless bounders default to the trigger layer
+    BounderComponent(GameObject & gameObject, unsigned int weight, BounderShape::Type shapeType, const SpatialComponent * spatial = nullptr);
 
     public:
 
@@ -39,10 +108,14 @@ class BounderComponent : public Component {
 
     virtual void update(float dt) = 0;
 
-    virtual bool collide(const BounderComponent & o, glm::vec3 * delta) const = 0;
+    bool collide(const BounderComponent & o, glm::vec3 * delta) const;
 
     virtual Intersect intersect(const Ray & ray) const = 0;
 
+    // Sweeps the bounder from its previous to its current position and
+    // calculates where its center is when it first touches the other bounder
+    Intersect sweep(const BounderComponent & o) const;
+
     virtual AABox enclosingAABox() const = 0;
     virtual Sphere enclosingSphere() const = 0;
 
@@ -54,6 +127,26 @@ class BounderComponent : public Component {
 
     unsigned int weight() const { return m_weight; }
 
+    BounderShape::Type shapeType() const { return m_shapeType; }
+
+    BounderShape transShape() const;
+    BounderShape prevTransShape() const;
+
+    // unique for the lifetime of the program
+    unsigned int id() const { return m_id; }
+
+    // index into the collision system's dense bounder array, or -1 if not yet added
+    int index() const { return m_index; }
+
+    unsigned int layer() const { return m_layer; }
+    unsigned int mask() const { return m_mask; }
+
+    // the layer should be a single bit
+    void setLayer(unsigned int layer, unsigned int mask = k_allLayers);
+
+    // whether the layers and masks of the two bounders allow them to collide
+    bool collidesWith(const BounderComponent & o) const { return (m_mask & o.m_layer) && (o.m_mask & m_layer); }
+
     bool isChange() const { return m_isChange; }
 
     virtual glm::vec3 groundPosition() const = 0;
@@ -61,8 +154,16 @@ class BounderComponent : public Component {
     protected:
 
     const SpatialComponent * m_spatial;
+    unsigned int m_id;
+    int m_index;
     unsigned int m_weight;
+    const BounderShape::Type m_shapeType;
+    unsigned int m_layer;
+    unsigned int m_mask;
     bool m_isChange;
+    // where the bounder has stayed near, and for how many frames
+    AABox m_restBox;
+    int m_restFrames;
 
 };
 
@@ -89,8 +190,6 @@ class AABBounderComponent : public BounderComponent {
 
     virtual void update(float dt) override;
 
-    virtual bool collide(const BounderComponent & o, glm::vec3 * delta) const override;
-
     virtual Intersect intersect(const Ray & ray) const override;
     
     virtual AABox enclosingAABox() const override;
@@ -137,8 +236,6 @@ class SphereBounderComponent : public BounderComponent {
 
     virtual void update(float dt) override;
 
-    virtual bool collide(const BounderComponent & o, glm::vec3 * delta) const override;
-
     virtual Intersect intersect(const Ray & ray) const override;
     
     virtual AABox enclosingAABox() const override;
@@ -185,8 +282,6 @@ class CapsuleBounderComponent : public BounderComponent {
 
     virtual void update(float dt) override;
 
-    virtual bool collide(const BounderComponent & o, glm::vec3 * delta) const override;
-
     virtual Intersect intersect(const Ray & ray) const override;
     
     virtual AABox enclosingAABox() const override;
@@ -209,4 +304,50 @@ class CapsuleBounderComponent : public BounderComponent {
     Capsule m_transCapsule;
     Capsule m_prevTransCapsule;
 
-};
\ No newline at end of file
+};
+
+
+
+// Collides exactly with the triangles of a mesh through a BVH, which is
+// rebuilt in world space whenever the game object moves. Meant for static
+// level geometry, so it is never critical, and sweeping it treats it as its
+// enclosing box
+// *** HAS TO BE ADDED TO SCENE AS BOUNDERCOMPONENT ***
+class MeshBounderComponent : public BounderComponent {
+
+    friend Scene;
+    friend CollisionSystem;
+
+    protected: // only scene or friends can create component
+
+    MeshBounderComponent(GameObject & gameObject, unsigned int weight, const Mesh & mesh, const SpatialComponent * spatial = nullptr);
+
+    public:
+
+    MeshBounderComponent(MeshBounderComponent && other) = default;
+
+    virtual void update(float dt) override;
+
+    virtual Intersect intersect(const Ray & ray) const override;
+
+    virtual AABox enclosingAABox() const override;
+    virtual Sphere enclosingSphere() const override;
+
+    virtual glm::vec3 center() const override { return m_bvh.box().center(); }
+    virtual glm::vec3 prevCenter() const override { return m_prevBox.center(); }
+
+    virtual bool isCritical() const override { return false; }
+
+    const Mesh & mesh() const { return m_mesh; }
+    const MeshBVH & bvh() const { return m_bvh; }
+
+    virtual glm::vec3 groundPosition() const override;
+
+    private:
+
+    const Mesh & m_mesh;
+    MeshBVH m_bvh;
+    AABox m_prevBox;
+    bool m_isBuilt;
+
+};
@@ -36,6 +36,10 @@ class Component {
         GameObject & gameObject() { return *m_gameObject; }
         const GameObject & gameObject() const { return *m_gameObject; }
 
+        // null once the game object has been killed, while the component
+        // waits to be removed, when gameObject() mustn't be used
+        const GameObject * gameObjectIfAlive() const { return m_gameObject; }
+
     private:
 
         GameObject * m_gameObject;
@@ -105,6 +105,7 @@ void MapExploreComponent::update(float dt) {
 
 		// Second floor height pass
 		if (secondFloorPass) {
+			Vector<Ray> rays;
 			for (int zIndex = 0; zIndex < secondFloorDepth; zIndex += stepSize) {
 				for (int xIndex = 0; xIndex < secondFloorWidth; xIndex += stepSize) {
 					xPos = xIndex + secondFloorStart_x;
@@ -112,17 +113,21 @@ void MapExploreComponent::update(float dt) {
 
 					//std::cout << "Pos: " << xPos << ", " << zPos << std::endl;
 
-					auto pair(CollisionSystem::pickHeavy(Ray(glm::vec3(xPos, secondFloorHeight, zPos), glm::vec3(0, -1, 0)), UINT_MAX));
-					if (pair.second.is) {
-						testPoint = glm::vec3(xPos, secondFloorHeight - pair.second.dist, zPos);
+					rays.emplace_back(glm::vec3(xPos, secondFloorHeight, zPos), glm::vec3(0, -1, 0));
+				}
 
-						if (visitedSet.find(testPoint) == visitedSet.end()) {
-							visitedSet.insert(testPoint);
-							//drawCup(testPoint);
-						}
+			}
+			Vector<std::pair<const BounderComponent *, Intersect>> results;
+			CollisionSystem::pickBatch(rays, UINT_MAX, results, Util::infinity(), BounderComponent::k_staticLayer);
+			for (int i = 0; i < int(rays.size()); i++) {
+				if (results[i].second.is) {
+					testPoint = glm::vec3(rays[i].pos.x, secondFloorHeight - results[i].second.dist, rays[i].pos.z);
+
+					if (visitedSet.find(testPoint) == visitedSet.end()) {
+						visitedSet.insert(testPoint);
+						//drawCup(testPoint);
 					}
 				}
-
 			}
 			std::cout << "Second Floor Done: " << visitedSet.size() << std::endl;
 			secondFloorPass = false;
@@ -131,19 +136,24 @@ void MapExploreComponent::update(float dt) {
 		}
 		// First floor height pass
 		else if (firstFloorPass) {
+			Vector<Ray> rays;
 			for (int zIndex = 0; zIndex < firstFloorDepth; zIndex += stepSize) {
 				for (int xIndex = 0; xIndex < firstFloorWidth; xIndex += stepSize) {
 					xPos = xIndex + firstFloorStart_x;
 					zPos = zIndex + firstFloorStart_z;
 
-					auto pair(CollisionSystem::pickHeavy(Ray(glm::vec3(xPos, firstFloorHeight, zPos), glm::vec3(0, -1, 0)), UINT_MAX));
-					if (pair.second.is) {
-						testPoint = glm::vec3(xPos, firstFloorHeight - pair.second.dist, zPos);
-
-						if (visitedSet.find(testPoint) == visitedSet.end()) {
-							visitedSet.insert(testPoint);
-							//drawCup(testPoint);
-						}
+					rays.emplace_back(glm::vec3(xPos, firstFloorHeight, zPos), glm::vec3(0, -1, 0));
+				}
+			}
+			Vector<std::pair<const BounderComponent *, Intersect>> results;
+			CollisionSystem::pickBatch(rays, UINT_MAX, results, Util::infinity(), BounderComponent::k_staticLayer);
+			for (int i = 0; i < int(rays.size()); i++) {
+				if (results[i].second.is) {
+					testPoint = glm::vec3(rays[i].pos.x, firstFloorHeight - results[i].second.dist, rays[i].pos.z);
+
+					if (visitedSet.find(testPoint) == visitedSet.end()) {
+						visitedSet.insert(testPoint);
+						//drawCup(testPoint);
 					}
 				}
 			}
@@ -228,7 +238,6 @@ void MapExploreComponent::update(float dt) {
 			 	}
 			 }
 // int loopCount = 0;
-		PathfindingSystem::vecvecMap cameFrom = PathfindingSystem::vecvecMap();
 // 			for (auto iter = graph.begin(); iter != graph.end();) {
 // 				std::cout << "path loop: " << loopCount++ << std::endl;
 // 				if (!PathfindingComponent::aStarSearch(graph, glm::vec3(-9, -1.688156, -172), iter->first, cameFrom)) {
@@ -253,7 +262,10 @@ void MapExploreComponent::update(float dt) {
 
 			//-20, 4.05946, -181
 			//40, 4.05946, 15
-			if (PathfindingComponent::aStarSearch(graph, glm::vec3(-9, -1.688156, -172), glm::vec3(40, 4.05946, 15), cameFrom)) {
+			NavGraph testGraph;
+			PathfindingSystem::buildGraph(graph, testGraph);
+			Vector<glm::vec3> testPath;
+			if (PathfindingSystem::findPath(testGraph, glm::vec3(-9, -1.688156, -172), glm::vec3(40, 4.05946, 15), testPath)) {
 				std::cout << "A* found a path between the test points" << std::endl;
 			}
 			else {
@@ -353,8 +365,19 @@ void MapExploreComponent::writeToFile(PathfindingSystem::vecvectorMap &graph) {
 
 		}
 	}
-
-
+	outFile.close();
+
+	// the binary form and the zones are kept alongside, so they needn't be
+	// built on loading. The graph is read back from the text, so it's just
+	// what loading the text would give, and the binary knows what it's of
+	NavGraph navGraph;
+	if (!navGraph.readText(filename)) {
+		return;
+	}
+	navGraph.write(PathfindingSystem::navFileName(filename));
+	NavHierarchy hierarchy;
+	hierarchy.build(navGraph);
+	hierarchy.write(PathfindingSystem::zonesFileName(filename));
 }
 
 std::string MapExploreComponent::vectorToString(Vector<glm::vec3> vec) {
@@ -1,7 +1,6 @@
 #pragma once
 
 #include <iostream>
-#include <queue>
 
 #include "glm/glm.hpp"
 #include "glm/gtc/constants.hpp"
@@ -13,26 +12,6 @@
 
 class BounderComponent;
 
-struct Node {
-	glm::vec3 position;
-	Vector<glm::vec3> neighbors;
-
-	Node(glm::vec3 pos, Vector<glm::vec3> neighbors) :
-		position(pos),
-		neighbors(neighbors)
-	{}
-};
-
-struct pathPair {
-    glm::vec3 position;
-    double priority;
-
-    pathPair(glm::vec3 pos, double pri) :
-        position(pos),
-        priority(pri)
-    {}
-};
-
 
 class PathfindingComponent : public Component {
 
@@ -46,16 +25,17 @@ class PathfindingComponent : public Component {
 
     PathfindingComponent(PathfindingComponent && other) = default;
 
+    virtual ~PathfindingComponent() override;
+
     // 45 degrees
     static constexpr float k_defCriticalAngle = glm::pi<float>() * 0.25f;
+    // seconds between requests for a path, when beyond the target's field
+    static constexpr float k_replanTime = 1.0f;
 
     protected:
 
     virtual void init() override;
 
-    void readInGraph(String);
-    Vector<glm::vec3> reconstructPath(glm::vec3 start, glm::vec3 playerPos, PathfindingSystem::vecvecMap &cameFrom);
-
 
     // cosine of most severe angle that can still be considered "ground"
     float m_cosCriticalAngle;
@@ -64,9 +44,6 @@ class PathfindingComponent : public Component {
 
     virtual void update(float) override;
 
-    static bool aStarSearch(PathfindingSystem::vecvectorMap &graph, glm::vec3 start, glm::vec3 playerPos, PathfindingSystem::vecvecMap &cameFrom);
-    static glm::vec3 closestPos(PathfindingSystem::vecvectorMap &graph, glm::vec3 pos);
-
     // TODO : just add enable/disable options for all components?
     void setMoveSpeed(float f) { this->m_moveSpeed = f; }
 
@@ -77,12 +54,14 @@ class PathfindingComponent : public Component {
     const BounderComponent * m_bounder;
     float m_moveSpeed;
 
-    bool updatePath;
-    int pathCount;
-    bool noPath = false;
+    uint32_t m_waypoint; // node being headed for, or NavGraph::k_invalid
+    unsigned int m_fieldVersion; // of the target's field m_waypoint came from
 
-    PathfindingSystem::vecvecMap cameFrom;
-    Vector<glm::vec3> path;
-    std::vector<glm::vec3>::iterator pathIT;
+    // followed while the target's field doesn't reach
+    Vector<glm::vec3> m_path;
+    int m_pathI; // position being headed for
+    unsigned int m_request;
+    bool m_isRequestPending;
+    float m_replanCooldown;
 
 };
\ No newline at end of file
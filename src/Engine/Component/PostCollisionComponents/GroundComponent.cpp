@@ -12,7 +12,8 @@ const float GroundComponent::k_defCriticalAngle = glm::pi<float>() * 0.25f; // 4
 
 GroundComponent::GroundComponent(GameObject & gameObject, float criticalAngle) :
     Component(gameObject),
-    m_cosCriticalAngle(std::cos(criticalAngle))
+    m_cosCriticalAngle(std::cos(criticalAngle)),
+    m_isAsleep(false)
 {}
 
 void GroundComponent::init() {
@@ -24,9 +25,22 @@ void GroundComponent::init() {
         }
     });
     Scene::addReceiver<CollisionNormMessage>(&gameObject(), collisionCallback);
+
+    auto sleepCallback([&](const Message & msg_) {
+        m_isAsleep = true;
+    });
+    Scene::addReceiver<SleepMessage>(&gameObject(), sleepCallback);
+
+    auto wakeCallback([&](const Message & msg_) {
+        m_isAsleep = false;
+    });
+    Scene::addReceiver<WakeMessage>(&gameObject(), wakeCallback);
 }
 
 void GroundComponent::update(float dt) {
+    if (m_isAsleep) {
+        return;
+    }
     m_groundNorm = Util::safeNorm(m_potentialGroundNorm);
     m_potentialGroundNorm = glm::vec3();
 }
@@ -50,5 +50,6 @@ class GroundComponent : public Component {
     float m_cosCriticalAngle; // cosine of most severe angle that can still be considered "ground"
     glm::vec3 m_groundNorm;
     glm::vec3 m_potentialGroundNorm;
+    bool m_isAsleep; // no collisions happen while asleep, so the ground is kept
 
 };
\ No newline at end of file
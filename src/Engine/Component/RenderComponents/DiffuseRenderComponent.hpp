@@ -12,16 +12,13 @@
 class RenderSystem;
 class Mesh;
 class SpatialComponent;
-class DiffuseShader;
-class ShadowDepthShader;
 
 
 
 class DiffuseRenderComponent : public Component {
 
     friend Scene;
-    friend DiffuseShader;
-    friend ShadowDepthShader;
+    friend RenderSystem;
 
     private:
 
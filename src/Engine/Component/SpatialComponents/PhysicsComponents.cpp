@@ -13,78 +13,111 @@
 NewtonianComponent::NewtonianComponent(GameObject & gameObject, bool isBouncy) :
     Component(gameObject),
     m_spatial(nullptr),
+    m_bodyI(-1),
     m_velocity(),
     m_acceleration(),
-    m_isBouncy(isBouncy)
+    m_isBouncy(isBouncy),
+    m_isAsleep(false)
 {}
 
 void NewtonianComponent::init() {
     if (!(m_spatial = gameObject().getSpatial())) assert(false);
 
+    // anything given before now carries over
+    m_bodyI = SpatialSystem::addBody(*this);
+    SpatialSystem::setBodyVelocity(m_bodyI, m_velocity);
+    SpatialSystem::accelerateBody(m_bodyI, m_acceleration);
+    setAsleep(m_isAsleep);
+
     auto collisionCallback([&](const Message & msg_) {
         const CollisionNormMessage & msg(static_cast<const CollisionNormMessage &>(msg_));
 
         // Calculate "friction"
-        float y(-glm::dot(m_velocity, msg.norm)); // speed into surface
+        glm::vec3 velocity(this->velocity());
+        float y(-glm::dot(velocity, msg.norm)); // speed into surface
         if (y <= 0.0) { // not trying to move into surface
             return;
         }
 
         if (m_isBouncy && -glm::dot(m_spatial->effectiveVelocity(), msg.norm) >= SpatialSystem::k_bounceVelThreshold) {
-            m_velocity = glm::reflect(m_velocity, msg.norm) * SpatialSystem::k_elasticity;
+            storeVelocity(glm::reflect(velocity, msg.norm) * SpatialSystem::k_elasticity);
             Scene::sendMessage<BounceMessage>(&gameObject(), msg.norm);
             return;
         }
 
-        glm::vec3 v(m_velocity + y * msg.norm); // would-be velocity along surface
+        glm::vec3 v(velocity + y * msg.norm); // would-be velocity along surface
         float x(glm::length2(v)); // length of v
         if (Util::isZero(x)) {
-            m_velocity = glm::vec3();
+            storeVelocity(glm::vec3());
             return;
         }
         x = std::sqrt(x);
         float factor(y / x * SpatialSystem::k_coefficientOfFriction);
         if (factor >= 1.0f) { // frictional force prevents movement
-            m_velocity = glm::vec3();
+            storeVelocity(glm::vec3());
             return;
         }
-        m_velocity = v * (1.0f - factor);
+        storeVelocity(v * (1.0f - factor));
     });
     Scene::addReceiver<CollisionNormMessage>(&gameObject(), collisionCallback);
-}
 
-void NewtonianComponent::update(float dt) {
-    glm::vec3 newVelocity(m_velocity + m_acceleration * dt);
-    float speed2(glm::length2(newVelocity));
-    if (speed2 > SpatialSystem::k_terminalVelocity *  SpatialSystem::k_terminalVelocity) {
-        newVelocity *= SpatialSystem::k_terminalVelocity / std::sqrt(speed2);
-    }
-    glm::vec3 delta(0.5f * dt * (m_velocity + newVelocity));
-    if (!Util::isZero(glm::length2(delta))) {
-        m_spatial->move(delta);
-    }
-    m_velocity = newVelocity;
-    m_acceleration = glm::vec3();
+    auto sleepCallback([&](const Message & msg_) {
+        setAsleep(true);
+        storeVelocity(glm::vec3());
+    });
+    Scene::addReceiver<SleepMessage>(&gameObject(), sleepCallback);
+
+    auto wakeCallback([&](const Message & msg_) {
+        setAsleep(false);
+    });
+    Scene::addReceiver<WakeMessage>(&gameObject(), wakeCallback);
 }
 
 void NewtonianComponent::accelerate(const glm::vec3 & acceleration) {
-    m_acceleration += acceleration;
+    if (m_bodyI >= 0) {
+        SpatialSystem::accelerateBody(m_bodyI, acceleration);
+    }
+    else {
+        m_acceleration += acceleration;
+    }
 }
 
 void NewtonianComponent::addVelocity(const glm::vec3 & velocity) {
-    m_velocity += velocity;
+    storeVelocity(this->velocity() + velocity);
+    if (velocity != glm::vec3()) setAsleep(false);
 }
 
 void NewtonianComponent::setVelocity(const glm::vec3 & velocity) {
-    m_velocity = velocity;
+    storeVelocity(velocity);
+    if (velocity != glm::vec3()) setAsleep(false);
 }
 
 void NewtonianComponent::removeAllVelocityAgainstDir(const glm::vec3 & dir) {
-    m_velocity = Util::removeAllAgainst(m_velocity, dir);
+    storeVelocity(Util::removeAllAgainst(velocity(), dir));
 }
 
 void NewtonianComponent::removeSomeVelocityAgainstDir(const glm::vec3 & dir, float amount) {
-    m_velocity = Util::removeSomeAgainst(m_velocity, dir, amount);
+    storeVelocity(Util::removeSomeAgainst(velocity(), dir, amount));
+}
+
+glm::vec3 NewtonianComponent::velocity() const {
+    return m_bodyI >= 0 ? SpatialSystem::bodyVelocity(m_bodyI) : m_velocity;
+}
+
+void NewtonianComponent::storeVelocity(const glm::vec3 & velocity) {
+    if (m_bodyI >= 0) {
+        SpatialSystem::setBodyVelocity(m_bodyI, velocity);
+    }
+    else {
+        m_velocity = velocity;
+    }
+}
+
+void NewtonianComponent::setAsleep(bool asleep) {
+    m_isAsleep = asleep;
+    if (m_bodyI >= 0) {
+        SpatialSystem::s_bodies.isActive[m_bodyI] = asleep ? 0.0f : 1.0f;
+    }
 }
 
 
@@ -92,23 +125,16 @@ void NewtonianComponent::removeSomeVelocityAgainstDir(const glm::vec3 & dir, flo
 AcceleratorComponent::AcceleratorComponent(GameObject & gameObject, const glm::vec3 & acceleration) :
     Component(gameObject),
     m_newtonian(nullptr),
-    m_acceleration(acceleration)
+    m_acceleration(acceleration),
+    m_isGravity(false)
 {}
 
 void AcceleratorComponent::init() {
     if (!(m_newtonian = gameObject().getComponentByType<NewtonianComponent>())) assert(false);
 }
 
-void AcceleratorComponent::update(float dt) {
-    m_newtonian->accelerate(m_acceleration);
-}
-
-
-
 GravityComponent::GravityComponent(GameObject & gameObject) :
     AcceleratorComponent(gameObject, SpatialSystem::gravity())
-{}
-
-void GravityComponent::update(float dt) {
-    m_newtonian->accelerate(SpatialSystem::gravity());
+{
+    m_isGravity = true;
 }
\ No newline at end of file
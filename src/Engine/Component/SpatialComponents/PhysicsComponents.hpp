@@ -12,10 +12,13 @@ class SpatialComponent;
 
 
 
-// has a velocity and can undergo classical mechanics operations
+// has a velocity and can undergo classical mechanics operations. Once
+// initialized, its velocity and acceleration live in the spatial system,
+// which integrates all bodies together
 class NewtonianComponent : public Component {
 
     friend Scene;
+    friend SpatialSystem;
 
   protected: // only scene or friends can create component
 
@@ -33,8 +36,6 @@ class NewtonianComponent : public Component {
 
   public:
 
-    virtual void update(float dt) override;
-
     void accelerate(const glm::vec3 & acceleration);
 
     void addVelocity(const glm::vec3 & velocity);
@@ -46,24 +47,35 @@ class NewtonianComponent : public Component {
     // dir should be normalized
     void removeSomeVelocityAgainstDir(const glm::vec3 & dir, float amount);
 
-    const glm::vec3 & velocity() const { return m_velocity; }
+    glm::vec3 velocity() const;
+
+  private:
+
+    void storeVelocity(const glm::vec3 & velocity);
+
+    void setAsleep(bool asleep);
 
   protected:
 
     SpatialComponent * m_spatial;
-    glm::vec3 m_velocity;
-    glm::vec3 m_acceleration;
+    int m_bodyI; // slot in the spatial system, or -1 until initialized
+    glm::vec3 m_velocity; // only until initialized
+    glm::vec3 m_acceleration; // only until initialized
     bool m_isBouncy;
+    // while asleep the object is at rest and isn't integrated. Giving it
+    // velocity wakes it
+    bool m_isAsleep;
 
 
 };
 
 
 
-// accelerates the object by the given amount
+// accelerates the object by the given amount. Applied by the spatial system
 class AcceleratorComponent : public Component {
 
     friend Scene;
+    friend SpatialSystem;
 
   protected: // only scene or friends can create component
 
@@ -79,14 +91,11 @@ class AcceleratorComponent : public Component {
 
     virtual void init() override;
 
-  public:
-
-    virtual void update(float dt) override;
-
   protected:
 
     NewtonianComponent * m_newtonian;
     glm::vec3 m_acceleration;
+    bool m_isGravity; // accelerates by the current gravity rather than m_acceleration
 
 };
 
@@ -108,6 +117,4 @@ class GravityComponent : public AcceleratorComponent {
 
     virtual ~GravityComponent() = default;
 
-    virtual void update(float dt) override;
-
 };
@@ -1,5 +1,6 @@
 #include "SpatialComponent.hpp"
 #include "System/SpatialSystem.hpp"
+#include "System/TransformSystem.hpp"
 
 #include "glm/gtc/matrix_transform.hpp"
 
@@ -21,11 +22,10 @@ SpatialComponent::SpatialComponent(GameObject & gameObject, SpatialComponent * p
     m_children(),
     m_dt(std::numeric_limits<float>::infinity()),
 
-    m_modelMat(), m_prevModelMat(),
-    m_normalMat(), m_prevNormalMat(),
-    m_modelMatValid(false), m_prevModelMatValid(false),
-    m_normalMatValid(false), m_prevNormalMatValid(false),
-    m_modelMatChanged(false), m_normalMatChanged(false)
+    m_transformI(TransformSystem::addSlot(*this)),
+    m_modelMatChanged(false), m_normalMatChanged(false),
+    m_world(), m_prevWorld(),
+    m_worldValid(false), m_prevWorldValid(false)
 {
     if (m_parent) m_parent->m_children.push_back(this);
 }
@@ -67,13 +67,14 @@ SpatialComponent::SpatialComponent(SpatialComponent && o) :
     m_children(std::move(o.m_children)),
     m_dt(o.m_dt),
 
-    m_modelMat(o.m_modelMat), m_prevModelMat(o.m_prevModelMat),
-    m_normalMat(o.m_normalMat), m_prevNormalMat(o.m_prevNormalMat),
-    m_modelMatValid(o.m_modelMatValid), m_prevModelMatValid(o.m_prevModelMatValid),
-    m_normalMatValid(o.m_normalMatValid), m_prevNormalMatValid(o.m_prevNormalMatValid),
-    m_modelMatChanged(o.m_modelMatChanged), m_normalMatChanged(o.m_normalMatChanged)
+    m_transformI(o.m_transformI),
+    m_modelMatChanged(o.m_modelMatChanged), m_normalMatChanged(o.m_normalMatChanged),
+    m_world(o.m_world), m_prevWorld(o.m_prevWorld),
+    m_worldValid(o.m_worldValid), m_prevWorldValid(o.m_prevWorldValid)
 {
     o.m_parent = nullptr;
+    o.m_transformI = -1;
+    TransformSystem::s_transforms.spatials[m_transformI] = this;
 
     if (m_parent) {
         m_parent->orphan(o);
@@ -82,6 +83,13 @@ SpatialComponent::SpatialComponent(SpatialComponent && o) :
     for (SpatialComponent * child : m_children) {
         child->m_parent = this;
     }
+    TransformSystem::invalidateOrder();
+}
+
+SpatialComponent::~SpatialComponent() {
+    if (m_transformI >= 0) {
+        TransformSystem::removeSlot(m_transformI);
+    }
 }
 
 void SpatialComponent::update(float dt) {
@@ -100,14 +108,17 @@ void SpatialComponent::update(float dt) {
         m_prevRelOrientMatrix = m_relOrientMatrix;
         m_isRelOrientationChange = false;
     }
+    TransformSystem::Transforms & t(TransformSystem::s_transforms);
     if (m_modelMatChanged) {
-        if (m_modelMatValid) m_prevModelMat = m_modelMat;
-        m_prevModelMatValid = m_modelMatValid;
+        if (t.isModelValid[m_transformI]) t.prevModels[m_transformI] = t.models[m_transformI];
+        t.isPrevModelValid[m_transformI] = t.isModelValid[m_transformI];
+        if (m_worldValid) m_prevWorld = m_world;
+        m_prevWorldValid = m_worldValid;
         m_modelMatChanged = false;
     }
     if (m_normalMatChanged) {
-        if (m_normalMatValid) m_prevNormalMat = m_normalMat;
-        m_prevNormalMatValid = m_normalMatValid;
+        if (t.isNormalValid[m_transformI]) t.prevNormals[m_transformI] = t.normals[m_transformI];
+        t.isPrevNormalValid[m_transformI] = t.isNormalValid[m_transformI];
         m_normalMatChanged = false;
     }
 }
@@ -117,6 +128,7 @@ void SpatialComponent::orphan(SpatialComponent & child) {
         if (*it == &child) {
             m_children.erase(it);
             child.m_parent = nullptr;
+            TransformSystem::invalidateOrder();
             return;
         }
     }
@@ -218,11 +230,11 @@ glm::vec3 SpatialComponent::relativePosition(float interpP) const {
 }
 
 glm::vec3 SpatialComponent::position() const {
-    return m_parent ? m_parent->modelMatrix() * glm::vec4(m_relPosition, 1.0f) : m_relPosition;
+    return m_parent ? worldTransform().position : m_relPosition;
 }
 
 glm::vec3 SpatialComponent::prevPosition() const {
-    return m_parent ? m_parent->prevModelMatrix() * glm::vec4(m_prevRelPosition, 1.0f) : m_prevRelPosition;
+    return m_parent ? prevWorldTransform().position : m_prevRelPosition;
 }
 
 glm::vec3 SpatialComponent::position(float interpP) const {
@@ -234,31 +246,11 @@ glm::vec3 SpatialComponent::relativeScale(float interpP) const {
 }
 
 glm::vec3 SpatialComponent::scale() const {
-    if (m_parent) {
-        const glm::mat4 & mat(m_parent->modelMatrix());
-        return glm::vec3(
-            glm::length(glm::vec3(mat[0])),
-            glm::length(glm::vec3(mat[1])),
-            glm::length(glm::vec3(mat[2]))
-        ) * m_relScale;
-    }
-    else {
-        return m_relScale;
-    }
+    return m_parent ? worldTransform().scale : m_relScale;
 }
 
 glm::vec3 SpatialComponent::prevScale() const {
-    if (m_parent) {
-        const glm::mat4 & mat(m_parent->prevModelMatrix());
-        return glm::vec3(
-            glm::length(glm::vec3(mat[0])),
-            glm::length(glm::vec3(mat[1])),
-            glm::length(glm::vec3(mat[2]))
-        ) * m_prevRelScale;
-    }
-    else {
-        return m_prevRelScale;
-    }
+    return m_parent ? prevWorldTransform().scale : m_prevRelScale;
 }
 
 glm::vec3 SpatialComponent::scale(float interpP) const {
@@ -278,27 +270,27 @@ glm::vec3 SpatialComponent::relativeW(float interpP) const {
 }
 
 glm::vec3 SpatialComponent::u() const {
-    return m_parent ? glm::normalize(glm::vec3(m_parent->modelMatrix() * glm::vec4(relativeU(), 0.0f))) : relativeU(); 
+    return m_parent ? worldTransform().u : relativeU();
 }
 
 glm::vec3 SpatialComponent::v() const {
-    return m_parent ? glm::normalize(glm::vec3(m_parent->modelMatrix() * glm::vec4(relativeV(), 0.0f))) : relativeV(); 
+    return m_parent ? worldTransform().v : relativeV();
 }
 
 glm::vec3 SpatialComponent::w() const {
-    return m_parent ? glm::normalize(glm::vec3(m_parent->modelMatrix() * glm::vec4(relativeW(), 0.0f))) : relativeW(); 
+    return m_parent ? worldTransform().w : relativeW();
 }
 
 glm::vec3 SpatialComponent::prevU() const {
-    return m_parent ? glm::normalize(glm::vec3(m_parent->prevModelMatrix() * glm::vec4(prevRelativeU(), 0.0f))) : prevRelativeU(); 
+    return m_parent ? prevWorldTransform().u : prevRelativeU();
 }
 
 glm::vec3 SpatialComponent::prevV() const {
-    return m_parent ? glm::normalize(glm::vec3(m_parent->prevModelMatrix() * glm::vec4(prevRelativeV(), 0.0f))) : prevRelativeV(); 
+    return m_parent ? prevWorldTransform().v : prevRelativeV();
 }
 
 glm::vec3 SpatialComponent::prevW() const {
-    return m_parent ? glm::normalize(glm::vec3(m_parent->prevModelMatrix() * glm::vec4(prevRelativeW(), 0.0f))) : prevRelativeW(); 
+    return m_parent ? prevWorldTransform().w : prevRelativeW();
 }
 
 glm::vec3 SpatialComponent::u(float interpP) const {
@@ -324,11 +316,11 @@ glm::mat3 SpatialComponent::relativeOrientMatrix(float interpP) const {
 }
 
 glm::quat SpatialComponent::orientation() const { 
-    return m_parent ? m_parent->orientation() * m_relOrientation : m_relOrientation;
+    return m_parent ? worldTransform().orientation : m_relOrientation;
 }
 
 glm::quat SpatialComponent::prevOrientation() const {
-    return m_parent ? m_parent->prevOrientation() * m_prevRelOrientation : m_prevRelOrientation;
+    return m_parent ? prevWorldTransform().orientation : m_prevRelOrientation;
 }
 
 glm::quat SpatialComponent::orientation(float interpP) const {
@@ -336,11 +328,11 @@ glm::quat SpatialComponent::orientation(float interpP) const {
 }
 
 glm::mat3 SpatialComponent::orientMatrix() const {
-    return m_parent ? m_parent->orientMatrix() * m_relOrientMatrix : m_relOrientMatrix;
+    return m_parent ? worldTransform().orientMatrix : m_relOrientMatrix;
 }
 
 glm::mat3 SpatialComponent::prevOrientMatrix() const {
-    return m_parent ? m_parent->prevOrientMatrix() * m_prevRelOrientMatrix : m_prevRelOrientMatrix;
+    return m_parent ? prevWorldTransform().orientMatrix : m_prevRelOrientMatrix;
 }
 
 glm::mat3 SpatialComponent::orientMatrix(float interpP) const {
@@ -348,25 +340,29 @@ glm::mat3 SpatialComponent::orientMatrix(float interpP) const {
 }
 
 const glm::mat4 & SpatialComponent::modelMatrix() const {
-    if (m_modelMatValid) {
-        return m_modelMat;
+    TransformSystem::Transforms & t(TransformSystem::s_transforms);
+    if (t.isModelValid[m_transformI]) {
+        return t.models[m_transformI];
     }
 
-    m_modelMat = Util::compositeTransform(m_relScale, m_relOrientMatrix, m_relPosition);
-    if (m_parent) m_modelMat = m_parent->modelMatrix() * m_modelMat;
-    m_modelMatValid = true;
-    return m_modelMat;
+    glm::mat4 mat(localModelMatrix());
+    if (m_parent) mat = m_parent->modelMatrix() * mat;
+    t.models[m_transformI] = mat;
+    t.isModelValid[m_transformI] = true;
+    return t.models[m_transformI];
 }
     
 const glm::mat4 & SpatialComponent::prevModelMatrix() const {
-    if (m_prevModelMatValid) {
-        return m_prevModelMat;
+    TransformSystem::Transforms & t(TransformSystem::s_transforms);
+    if (t.isPrevModelValid[m_transformI]) {
+        return t.prevModels[m_transformI];
     }
 
-    m_prevModelMat = Util::compositeTransform(m_prevRelScale, m_prevRelOrientMatrix, m_prevRelPosition);
-    if (m_parent) m_prevModelMat = m_parent->prevModelMatrix() * m_prevModelMat;
-    m_prevModelMatValid = true;
-    return m_prevModelMat;
+    glm::mat4 mat(prevLocalModelMatrix());
+    if (m_parent) mat = m_parent->prevModelMatrix() * mat;
+    t.prevModels[m_transformI] = mat;
+    t.isPrevModelValid[m_transformI] = true;
+    return t.prevModels[m_transformI];
 }
 
 glm::mat4 SpatialComponent::modelMatrix(float interpP) const {
@@ -380,27 +376,29 @@ glm::mat4 SpatialComponent::modelMatrix(float interpP) const {
 }
 
 const glm::mat3 & SpatialComponent::normalMatrix() const {
-    if (m_normalMatValid) {
-        return m_normalMat;
+    TransformSystem::Transforms & t(TransformSystem::s_transforms);
+    if (t.isNormalValid[m_transformI]) {
+        return t.normals[m_transformI];
     }
 
-    // this is valid and waaaaaaaay faster than inverting the model matrix
-    m_normalMat = m_relOrientMatrix * glm::mat3(glm::scale(glm::mat4(), 1.0f / m_relScale));
-    if (m_parent) m_normalMat = m_parent->normalMatrix() * m_normalMat;
-    m_normalMatValid = true;
-    return m_normalMat;
+    glm::mat3 mat(localNormalMatrix());
+    if (m_parent) mat = m_parent->normalMatrix() * mat;
+    t.normals[m_transformI] = mat;
+    t.isNormalValid[m_transformI] = true;
+    return t.normals[m_transformI];
 }
 
 const glm::mat3 & SpatialComponent::prevNormalMatrix() const {
-    if (m_prevNormalMatValid) {
-        return m_prevNormalMat;
+    TransformSystem::Transforms & t(TransformSystem::s_transforms);
+    if (t.isPrevNormalValid[m_transformI]) {
+        return t.prevNormals[m_transformI];
     }
 
-    // this is valid and waaaaaaaay faster than inverting the model matrix
-    m_prevNormalMat = m_prevRelOrientMatrix * glm::mat3(glm::scale(glm::mat4(), 1.0f / m_prevRelScale));
-    if (m_parent) m_prevNormalMat = m_parent->prevNormalMatrix() * m_prevNormalMat;
-    m_prevNormalMatValid = true;
-    return m_prevNormalMat;
+    glm::mat3 mat(prevLocalNormalMatrix());
+    if (m_parent) mat = m_parent->prevNormalMatrix() * mat;
+    t.prevNormals[m_transformI] = mat;
+    t.isPrevNormalValid[m_transformI] = true;
+    return t.prevNormals[m_transformI];
 }
 
 glm::mat3 SpatialComponent::normalMatrix(float interpP) const {
@@ -414,17 +412,78 @@ glm::mat3 SpatialComponent::normalMatrix(float interpP) const {
     }
 }
 
+glm::mat4 SpatialComponent::localModelMatrix() const {
+    return Util::compositeTransform(m_relScale, m_relOrientMatrix, m_relPosition);
+}
+
+glm::mat4 SpatialComponent::prevLocalModelMatrix() const {
+    return Util::compositeTransform(m_prevRelScale, m_prevRelOrientMatrix, m_prevRelPosition);
+}
+
+glm::mat3 SpatialComponent::localNormalMatrix() const {
+    // this is valid and waaaaaaaay faster than inverting the model matrix
+    return m_relOrientMatrix * glm::mat3(glm::scale(glm::mat4(), 1.0f / m_relScale));
+}
+
+glm::mat3 SpatialComponent::prevLocalNormalMatrix() const {
+    return m_prevRelOrientMatrix * glm::mat3(glm::scale(glm::mat4(), 1.0f / m_prevRelScale));
+}
+
 glm::vec3 SpatialComponent::effectiveVelocity() const {
     return (position() - prevPosition()) / m_dt;
 }
 
 void SpatialComponent::propagate(bool modelMatValid, bool normalMatValid, bool silently) const {
-    m_modelMatValid = m_modelMatValid && modelMatValid;
-    m_normalMatValid = m_normalMatValid && normalMatValid;
+    TransformSystem::Transforms & t(TransformSystem::s_transforms);
+    t.isModelValid[m_transformI] = t.isModelValid[m_transformI] && modelMatValid;
+    m_worldValid = m_worldValid && modelMatValid;
+    t.isNormalValid[m_transformI] = t.isNormalValid[m_transformI] && normalMatValid;
     m_modelMatChanged = m_modelMatChanged || !modelMatValid;
     m_normalMatChanged = m_normalMatChanged || !normalMatValid;
     if (!silently) Scene::sendMessage<SpatialChangeMessage>(&gameObject(), *this);
     for (SpatialComponent * child : m_children) {
         child->propagate(false, false, silently);
     }
+}
+
+const SpatialComponent::WorldTransform & SpatialComponent::worldTransform() const {
+    if (m_worldValid) {
+        return m_world;
+    }
+
+    const glm::mat4 & parentMat(m_parent->modelMatrix());
+    m_world.position = parentMat * glm::vec4(m_relPosition, 1.0f);
+    m_world.scale = glm::vec3(
+        glm::length(glm::vec3(parentMat[0])),
+        glm::length(glm::vec3(parentMat[1])),
+        glm::length(glm::vec3(parentMat[2]))
+    ) * m_relScale;
+    m_world.orientation = m_parent->orientation() * m_relOrientation;
+    m_world.orientMatrix = m_parent->orientMatrix() * m_relOrientMatrix;
+    m_world.u = glm::normalize(glm::vec3(parentMat * glm::vec4(relativeU(), 0.0f)));
+    m_world.v = glm::normalize(glm::vec3(parentMat * glm::vec4(relativeV(), 0.0f)));
+    m_world.w = glm::normalize(glm::vec3(parentMat * glm::vec4(relativeW(), 0.0f)));
+    m_worldValid = true;
+    return m_world;
+}
+
+const SpatialComponent::WorldTransform & SpatialComponent::prevWorldTransform() const {
+    if (m_prevWorldValid) {
+        return m_prevWorld;
+    }
+
+    const glm::mat4 & parentMat(m_parent->prevModelMatrix());
+    m_prevWorld.position = parentMat * glm::vec4(m_prevRelPosition, 1.0f);
+    m_prevWorld.scale = glm::vec3(
+        glm::length(glm::vec3(parentMat[0])),
+        glm::length(glm::vec3(parentMat[1])),
+        glm::length(glm::vec3(parentMat[2]))
+    ) * m_prevRelScale;
+    m_prevWorld.orientation = m_parent->prevOrientation() * m_prevRelOrientation;
+    m_prevWorld.orientMatrix = m_parent->prevOrientMatrix() * m_prevRelOrientMatrix;
+    m_prevWorld.u = glm::normalize(glm::vec3(parentMat * glm::vec4(prevRelativeU(), 0.0f)));
+    m_prevWorld.v = glm::normalize(glm::vec3(parentMat * glm::vec4(prevRelativeV(), 0.0f)));
+    m_prevWorld.w = glm::normalize(glm::vec3(parentMat * glm::vec4(prevRelativeW(), 0.0f)));
+    m_prevWorldValid = true;
+    return m_prevWorld;
 }
\ No newline at end of file
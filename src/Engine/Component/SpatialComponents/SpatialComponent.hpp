@@ -13,6 +13,7 @@
 
 
 class SpatialSystem;
+class TransformSystem;
 
 
 
@@ -26,6 +27,19 @@ class SpatialComponent : public Component {
 
     friend Scene;
     friend SpatialSystem;
+    friend TransformSystem;
+
+    // Absolute transform of a child spatial, cached alongside its model matrix
+    // so that repeated queries don't go back through the parent's
+    struct WorldTransform {
+
+        glm::vec3 position;
+        glm::vec3 scale;
+        glm::quat orientation;
+        glm::mat3 orientMatrix;
+        glm::vec3 u, v, w;
+
+    };
 
     protected: // only scene or friends can create component
 
@@ -39,6 +53,8 @@ class SpatialComponent : public Component {
 
     SpatialComponent(SpatialComponent && other);
 
+    virtual ~SpatialComponent() override;
+
     public:
 
     virtual void update(float dt) override;
@@ -158,6 +174,16 @@ class SpatialComponent : public Component {
 
     void propagate(bool modelMatValid, bool normalMatValid, bool silently) const;
 
+    // Relative to the parent, if any
+    glm::mat4 localModelMatrix() const;
+    glm::mat4 prevLocalModelMatrix() const;
+    glm::mat3 localNormalMatrix() const;
+    glm::mat3 prevLocalNormalMatrix() const;
+
+    // only valid for spatials with a parent
+    const WorldTransform & worldTransform() const;
+    const WorldTransform & prevWorldTransform() const;
+
     private:
 
     glm::vec3 m_relPosition, m_prevRelPosition;
@@ -171,10 +197,11 @@ class SpatialComponent : public Component {
     Vector<SpatialComponent *> m_children;
     float m_dt;
 
-    mutable glm::mat4 m_modelMat, m_prevModelMat;
-    mutable glm::mat3 m_normalMat, m_prevNormalMat;
-    mutable bool m_modelMatValid, m_prevModelMatValid;
-    mutable bool m_normalMatValid, m_prevNormalMatValid;
+    // the model and normal matrices are kept by TransformSystem in this slot
+    int m_transformI;
     mutable bool m_modelMatChanged, m_normalMatChanged;
+    // invalidated and rolled over along with the model matrix
+    mutable WorldTransform m_world, m_prevWorld;
+    mutable bool m_worldValid, m_prevWorldValid;
 
 };
\ No newline at end of file
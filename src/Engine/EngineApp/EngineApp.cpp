@@ -4,19 +4,26 @@
 #include <iostream>
 
 #include "IO/Window.hpp"
+#include "IO/Mouse.hpp"
 #include "Scene/Scene.hpp"
+#include "System/RenderSystem.hpp"
 #include "Util/Util.hpp"
+#include "Util/JobThread.hpp"
 #include "Loader/Loader.hpp"
 
 String EngineApp::RESOURCE_DIR = "../resources/";
 String EngineApp::APP_NAME = "Battle Royale with Cheese";
 int EngineApp::fps = 0;
 double EngineApp::timeStep = 0.0;
+int EngineApp::simRate = 60;
+bool EngineApp::pipelined = false;
 bool EngineApp::verbose = false;
 double EngineApp::lastFpsTime = 0.0;
 int EngineApp::nFrames = 0;
 double EngineApp::lastFrameTime = 0.0;
 double EngineApp::runTime = 0.0;
+double EngineApp::simTime = 0.0;
+UniquePtr<JobThread> EngineApp::simThread;
 
 int EngineApp::init() {
     srand((unsigned int)(time(0)));    
@@ -24,8 +31,14 @@ int EngineApp::init() {
         return 1;
     }
 
-    Scene::init();
+    /* Before the scene, which loads what it can up front */
     Loader::init(verbose, RESOURCE_DIR);
+    Scene::init();
+
+    /* Mapping loads its markers as it goes, which can't be done off this thread */
+    if (pipelined && !Scene::mapping) {
+        simThread = UniquePtr<JobThread>::make();
+    }
 
     lastFrameTime = runTime = Util::time();
    
@@ -33,11 +46,12 @@ int EngineApp::init() {
 }
 
 void EngineApp::run() {
+    const double simStep(1.0 / simRate);
 
     while (!Window::shouldClose()) {
         /* Update time and FPS */
         runTime = Util::time();
-        timeStep = glm::min((runTime - lastFrameTime), 0.25); // right now physics/collisions break when dt is too large, so this is a workaround
+        timeStep = glm::min((runTime - lastFrameTime), 0.25); // so a long hitch doesn't queue up a flood of simulation steps
         lastFrameTime = runTime;
         nFrames++;
         if (runTime - lastFpsTime >= 1.0) {
@@ -49,11 +63,41 @@ void EngineApp::run() {
         /* Update display, mouse, and keyboard */
         Window::update(float(timeStep));
 
-        /* Update all game objects and components */
-        Scene::update(float(timeStep));
+        /* Where the frame falls between the last two steps, before any more are taken */
+        float interpP(float(simTime / simStep));
+
+        /* Simulate in fixed steps, as many as have built up */
+        simTime += timeStep;
+        int nSteps(0);
+        while (simTime >= simStep) {
+            simTime -= simStep;
+            ++nSteps;
+        }
+
+        if (simThread && RenderSystem::canDrawConcurrently()) {
+            /* Draw the last steps on this thread, which owns the GL context, while the next are simulated */
+            Scene::capture(float(timeStep), interpP);
+            simThread->start([nSteps, simStep]() { simulate(nSteps, simStep); });
+            Scene::draw();
+            simThread->wait();
+        }
+        else {
+            simulate(nSteps, simStep);
+            /* Render between the last two steps */
+            Scene::render(float(timeStep), float(simTime / simStep));
+        }
     }
 }
 
 void EngineApp::terminate() {
+    simThread.release();
     Window::shutDown();
 }
+
+void EngineApp::simulate(int nSteps, double simStep) {
+    for (int i(0); i < nSteps; ++i) {
+        Scene::update(float(simStep));
+        /* Mouse movement builds up between steps and is used by just one */
+        Mouse::dx = Mouse::dy = 0.0;
+    }
+}
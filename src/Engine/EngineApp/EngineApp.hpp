@@ -4,6 +4,8 @@
 
 #include "Util/Memory.hpp"
 
+class JobThread;
+
 // static class
 class EngineApp {
 
@@ -17,6 +19,8 @@ class EngineApp {
         static String APP_NAME;       /* Name of application */
         static int fps;                    /* Frames per second */
         static double timeStep;            /* Delta time */
+        static int simRate;                /* Simulation steps per second */
+        static bool pipelined;             /* Simulate the next frame while drawing this one */
         static bool verbose;               /* Log things or not */
 
     private:
@@ -25,6 +29,10 @@ class EngineApp {
         static int nFrames;                /* Number of frames in current second */
         static double lastFrameTime;       /* Time at which last frame was rendered */
         static double runTime;             /* Global timer */
+        static double simTime;             /* Time not yet simulated */
+        static UniquePtr<JobThread> simThread; /* Runs the simulation when pipelined */
+
+        static void simulate(int nSteps, double simStep);
 
 };
 
@@ -83,6 +83,14 @@ struct SpatialChangeMessage : public Message {
     SpatialChangeMessage(const SpatialComponent & spatial) : spatial(spatial) {}
 };
 
+// physics moved these spatials silently this step, children included
+// the array belongs to the sender and stays valid until the next step
+struct SpatialsMovedMessage : public Message {
+    const SpatialComponent * const * spatials;
+    int nSpatials;
+    SpatialsMovedMessage(const SpatialComponent * const * spatials, int nSpatials) : spatials(spatials), nSpatials(nSpatials) {}
+};
+
 
 
 // a camera was rotated
@@ -116,6 +124,18 @@ struct CollisionAdjustMessage : public Message {
     CollisionAdjustMessage(const GameObject & gameObject, const glm::vec3 & delta) : gameObject(gameObject), delta(delta) {}
 };
 
+// the game object came to rest and its bounders are no longer being tested
+struct SleepMessage : public Message {
+    const GameObject & gameObject;
+    SleepMessage(const GameObject & gameObject) : gameObject(gameObject) {}
+};
+
+// the game object was moved or hit while asleep and its bounders are being tested again
+struct WakeMessage : public Message {
+    const GameObject & gameObject;
+    WakeMessage(const GameObject & gameObject) : gameObject(gameObject) {}
+};
+
 
 
 // a bouncy newtonian bounced
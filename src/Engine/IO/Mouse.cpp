@@ -16,9 +16,9 @@ void Mouse::update(double newX, double newY) {
         s_reset = false;
     }
 
-    /* Calculate x-y speed */
-    dx = newX - x;
-    dy = newY - y;
+    /* Calculate x-y speed, building up until used by a simulation step */
+    dx += newX - x;
+    dy += newY - y;
 
     /* Set new positions */
     // TODO: if newX > 0 and newY > 0
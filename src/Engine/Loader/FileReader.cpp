@@ -178,13 +178,13 @@ int FileReader::loadLevel(const char & filePath) {
         numberOfColliders += FileReader::addBoxColliderComponents(gameObject, jsonObject);
 
         const rapidjson::Value& allowColliders = jsonTransform["allowColliders"];
-        //Create a bounder if none have been created the the json allows colliders on the mesh
+        //Collide with the mesh itself if no colliders were given and the json allows colliders on the mesh
         if (numberOfColliders == 0 && allowColliders.GetBool()) {
-            CollisionSystem::addBounderFromMesh(gameObject, UINT_MAX, *Loader::getMesh(filePath), true, true, true);
+            Scene::addComponentAs<MeshBounderComponent, BounderComponent>(gameObject, UINT_MAX, *Loader::getMesh(filePath));
         }
 
         //Read the texture data from the json
-        if(filePath.compare("") != 0) {
+        if(filePath.compare("") != 0 && !Loader::isHeadless()) {
             DiffuseRenderComponent & renderComp(FileReader::addRenderComponent(gameObject, spatialComp, jsonTransform, filePath));
         }
     }
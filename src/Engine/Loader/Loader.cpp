@@ -5,17 +5,21 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "ThirdParty/stb_image.h"
 
+#include <cassert>
 #include <iostream>
 
 #include "Util/Memory.hpp"
 #include "FileReader.hpp"
 
 bool Loader::verbose = false;
+bool Loader::headless = false;
+std::thread::id Loader::glThread;
 String Loader::RESOURCE_DIR = "../resources/";
 
 void Loader::init(bool verbose, const String & res) {
     verbose = verbose;
     RESOURCE_DIR = res;
+    glThread = std::this_thread::get_id();
 }
 
 Mesh* Loader::getMesh(const String & name) {
@@ -23,6 +27,7 @@ Mesh* Loader::getMesh(const String & name) {
     if (mesh) {
         return mesh;
     }
+    assert(headless || std::this_thread::get_id() == glThread);
 
     std::vector<tinyobj::shape_t> shapes;
     std::vector<tinyobj::material_t> objMaterials;
@@ -65,7 +70,9 @@ Mesh* Loader::getMesh(const String & name) {
     Library::addMesh(name, *mesh);
     
     /* Load mesh to GPU */
-    loadMesh(*mesh);
+    if (!headless) {
+        loadMesh(*mesh);
+    }
 
     if (verbose) {
         std::cout << "Loaded mesh (" << vertCount << " vertices): " << name << std::endl;
@@ -97,6 +104,7 @@ Texture* Loader::getTexture(const String & name, GLenum mode, bool flip) {
     if (texture) {
         return texture;
     }
+    assert(headless || std::this_thread::get_id() == glThread);
 
     texture = new Texture;
     uint8_t *data = loadTextureData(RESOURCE_DIR + name, flip, &texture->width, &texture->height, &texture->components);
@@ -118,6 +126,10 @@ int Loader::loadLevel(const String & name) {
     return FileReader::loadLevel(*name.c_str());
 }
 
+void Loader::setHeadless(bool isHeadless) {
+    headless = isHeadless;
+}
+
 /* Provided function to resize a mesh so all vertex positions are [0, 1.f] */
 void Loader::resize(Mesh::MeshBuffers & buffers) {
     float minX, minY, minZ;
@@ -8,6 +8,7 @@
 #define GLEW_STATIC
 #include <GL/glew.h>
 #include <cstdint>
+#include <thread>
 
 #include "Model/Mesh.hpp"
 #include "Library.hpp"
@@ -17,6 +18,8 @@ class Loader {
     public:
         static void init(bool, const String &);
 
+        /* Anything not yet loaded must be loaded on the thread that called init, which owns the GL context */
+
         /* Retrieve Mesh pointer from an .obj file*/
         static Mesh* getMesh(const String &);
 
@@ -27,6 +30,10 @@ class Loader {
         /* Call file reader */
         static int loadLevel(const String &);
 
+        /* Keep meshes on the CPU only and skip textures, for running without a GL context */
+        static void setHeadless(bool);
+        static bool isHeadless() { return headless; }
+
     private:
         /* Resize mesh vertex buffers so all the vertices are [0, 1] */
         static void resize(Mesh::MeshBuffers &);
@@ -41,6 +48,8 @@ class Loader {
         /* Private members */
         static String RESOURCE_DIR;
         static bool verbose;
+        static bool headless;
+        static std::thread::id glThread;
 };
 
 #endif
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "System/GameSystem.hpp"
 #include "System/SpatialSystem.hpp"
+#include "System/TransformSystem.hpp"
 #include "System/PathfindingSystem.hpp"
 #include "System/MapExploreSystem.hpp"
 #include "System/CollisionSystem.hpp"
@@ -28,12 +29,14 @@ Vector<std::tuple<const GameObject *, std::type_index, UniquePtr<Message>>> Scen
 UnorderedMap<std::type_index, Vector<std::function<void (const Message &)>>> Scene::s_receivers;
 
 float Scene::totalDT;
+float Scene::stepDT;
 float Scene::initDT;
 float Scene::killDT;
 float Scene::gameDT;
 float Scene::gameMessagingDT;
 float Scene::spatialDT;
 float Scene::spatialMessagingDT;
+float Scene::transformDT;
 float Scene::pathfindingDT;
 float Scene::pathfindingMessagingDT;
 float Scene::collisionDT;
@@ -42,6 +45,7 @@ float Scene::postCollisionDT;
 float Scene::postCollisionMessagingDT;
 float Scene::particleDT;
 float Scene::particleMessagingDT;
+float Scene::captureDT;
 float Scene::renderDT;
 float Scene::renderMessagingDT;
 float Scene::soundDT;
@@ -52,6 +56,7 @@ String Scene::mapFilename;
 
 void Scene::init() {
     SpatialSystem::init();
+    TransformSystem::init();
     CollisionSystem::init();
     PostCollisionSystem::init();
     PathfindingSystem::init();
@@ -62,6 +67,12 @@ void Scene::init() {
     GameSystem::init();
 }
 
+void Scene::initHeadless() {
+    SpatialSystem::init();
+    TransformSystem::init();
+    CollisionSystem::init();
+}
+
 GameObject & Scene::createGameObject() {
     s_gameObjectInitQueue.emplace_back(UniquePtr<GameObject>::make(GameObject()));
     return *s_gameObjectInitQueue.back().get();
@@ -100,6 +111,9 @@ void Scene::update(float dt) {
     relayMessages();
     spatialMessagingDT = float(watch.lap());
 
+    TransformSystem::update();
+    transformDT = float(watch.lap());
+
     CollisionSystem::update(dt);
     collisionDT = float(watch.lap());
     relayMessages();
@@ -115,8 +129,26 @@ void Scene::update(float dt) {
     relayMessages();
     particleMessagingDT = float(watch.lap());
 
-    RenderSystem::update(dt); // rendering should be last
-    renderDT = float(watch.lap());
+    doKillQueue();
+    relayMessages();
+    killDT = float(watch.lap());
+
+    stepDT = float(watch.total());
+}
+
+void Scene::render(float dt, float interpP) {
+    capture(dt, interpP);
+    draw();
+}
+
+void Scene::capture(float dt, float interpP) {
+    Util::Stopwatch watch;
+
+    TransformSystem::update(); // for anything moved by collision and after
+    transformDT += float(watch.lap());
+
+    RenderSystem::capture(dt, interpP);
+    captureDT = float(watch.lap());
     relayMessages();
     renderMessagingDT = float(watch.lap());
 
@@ -125,19 +157,56 @@ void Scene::update(float dt) {
     relayMessages();
     soundMessagingDT = float(watch.lap());
 
-    doKillQueue();
-    relayMessages();
-    killDT = float(watch.lap());
-
-    totalDT = float(watch.total());
+    totalDT = stepDT + float(watch.total());
 
 #ifdef DEBUG_MODE
-    // Reports the state of the game, so should happen at end
+    // Reports the state of the game, so should happen at end. The panes are
+    // built here, while the scene is still, and drawn with the frame
     for (ImGuiComponent * comp : getComponents<ImGuiComponent>()) comp->update(dt);
+#endif
+}
+
+void Scene::draw() {
+    Util::Stopwatch watch;
+
+    RenderSystem::draw(); // rendering should be last
+    renderDT = float(watch.lap());
+
+    totalDT += renderDT;
+
+#ifdef DEBUG_MODE
     if (Window::isImGuiEnabled()) ImGui::Render();
 #endif
 }
 
+void Scene::updateHeadless(float dt) {
+    Util::Stopwatch watch;
+
+    doInitQueue();
+    relayMessages();
+    initDT = float(watch.lap());
+
+    for (SpatialComponent * comp : getComponents<SpatialComponent>()) { comp->update(dt); }
+    SpatialSystem::update(dt);
+    spatialDT = float(watch.lap());
+    relayMessages();
+    spatialMessagingDT = float(watch.lap());
+
+    TransformSystem::update();
+    transformDT = float(watch.lap());
+
+    CollisionSystem::update(dt);
+    collisionDT = float(watch.lap());
+    relayMessages();
+    collisionMessagingDT = float(watch.lap());
+
+    doKillQueue();
+    relayMessages();
+    killDT = float(watch.lap());
+
+    totalDT = float(watch.total());
+}
+
 void Scene::doInitQueue() {
     initGameObjects();
     initComponents();
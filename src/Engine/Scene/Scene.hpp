@@ -23,8 +23,23 @@ class Scene {
 
     static void init();
 
+    // Runs one fixed simulation step
     static void update(float);
 
+    // Renders and plays sound for a frame. interpP is how far the frame is
+    // between the previous and latest simulation steps
+    static void render(float dt, float interpP);
+
+    // The two halves of render. capture reads the scene, so no step may run
+    // during it, while draw only reads what was captured and may overlap the
+    // next step if RenderSystem::canDrawConcurrently
+    static void capture(float dt, float interpP);
+    static void draw();
+
+    // Only the spatial and collision systems, for running without a window
+    static void initHeadless();
+    static void updateHeadless(float);
+
     static GameObject & createGameObject();
 
     static void destroyGameObject(GameObject & gameObject);
@@ -81,12 +96,14 @@ class Scene {
   public:
 
     static float totalDT;
+    static float stepDT; // the last simulation step
     static float initDT;
     static float killDT;
     static float gameDT;
     static float gameMessagingDT;
     static float spatialDT;
     static float spatialMessagingDT;
+    static float transformDT;
     static float pathfindingDT;
     static float pathfindingMessagingDT;
     static float collisionDT;
@@ -95,6 +112,7 @@ class Scene {
     static float postCollisionMessagingDT;
     static float particleDT;
     static float particleMessagingDT;
+    static float captureDT;
     static float renderDT;
     static float renderMessagingDT;
     static float soundDT;
@@ -14,8 +14,7 @@
 
 namespace {
 
-glm::mat4 detAABBMat(const AABBounderComponent & bounder) {
-    const AABox & span(bounder.transBox());
+glm::mat4 detAABBMat(const AABox & span) {
     glm::vec3 loc((span.max - span.min) * 0.5f + span.min);
     glm::vec3 scale(span.max - loc);
     return Util::compositeTransform(scale, loc);
@@ -93,26 +92,26 @@ void BounderShader::render(const CameraComponent * camera) {
             continue;
         }
 
-        bool collided(CollisionSystem::s_collided.count(&bounder));
-        bool adjusted(CollisionSystem::s_adjusted.count(&bounder));
+        bool collided(CollisionSystem::s_collided.test(bounder.index()));
+        bool adjusted(CollisionSystem::s_adjusted.test(bounder.index()));
 
         loadVec3(getUniform("u_color"), collided ? adjusted ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(1.0f, 0.5f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f));
 
-        if (dynamic_cast<const AABBounderComponent *>(&bounder)) {
+        if (bounder.shapeType() == BounderShape::Type::aabox) {
             const AABBounderComponent & aabbBounder(static_cast<const AABBounderComponent &>(bounder));
-            loadMat4(getUniform("u_modelMat"), detAABBMat(aabbBounder));
+            loadMat4(getUniform("u_modelMat"), detAABBMat(aabbBounder.transBox()));
 
             glBindVertexArray(m_aabVAO);
             glDrawElements(GL_LINES, m_nAABIndices, GL_UNSIGNED_INT, nullptr);
         }
-        else if (dynamic_cast<const SphereBounderComponent *>(&bounder)) {
+        else if (bounder.shapeType() == BounderShape::Type::sphere) {
             const SphereBounderComponent & sphereBounder(static_cast<const SphereBounderComponent &>(bounder));
             loadMat4(getUniform("u_modelMat"), detSphereMat(sphereBounder));
 
             glBindVertexArray(m_sphereVAO);
             glDrawElements(GL_LINES, m_nSphereIndices, GL_UNSIGNED_INT, nullptr);
         }
-        else if (dynamic_cast<const CapsuleBounderComponent *>(&bounder)) {
+        else if (bounder.shapeType() == BounderShape::Type::capsule) {
             const CapsuleBounderComponent & capsuleBounder(static_cast<const CapsuleBounderComponent &>(bounder));
 
             auto capMats(detCapsuleCapMats(capsuleBounder));
@@ -127,6 +126,12 @@ void BounderShader::render(const CameraComponent * camera) {
             glBindVertexArray(m_rodVAO);
             glDrawElements(GL_LINES, m_nRodIndices, GL_UNSIGNED_INT, nullptr);
         }
+        else if (bounder.shapeType() == BounderShape::Type::mesh) {
+            loadMat4(getUniform("u_modelMat"), detAABBMat(bounder.enclosingAABox()));
+
+            glBindVertexArray(m_aabVAO);
+            glDrawElements(GL_LINES, m_nAABIndices, GL_UNSIGNED_INT, nullptr);
+        }
     }
 
     unbind();
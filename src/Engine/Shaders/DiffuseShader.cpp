@@ -156,7 +156,9 @@ bool DiffuseShader::init() {
 }
 
 void DiffuseShader::render(const CameraComponent * camera) {
-    if (!camera || !m_isEnabled) {
+    const RenderSnapshot & snapshot(RenderSystem::snapshot());
+    const RenderSnapshot::View * view(snapshot.view(camera));
+    if (!view || !m_isEnabled) {
         return;
     }
 
@@ -167,11 +169,11 @@ void DiffuseShader::render(const CameraComponent * camera) {
     }
 
     /* Bind uniforms */
-    loadMat4(getUniform("P"), camera->getProj());
-    loadMat4(getUniform("V"), camera->getView());
-    loadVec3(getUniform("lightDir"), RenderSystem::getLightDir());
-    loadVec3(getUniform("camPos"), camera->gameObject().getSpatial()->position());
-    loadFloat(getUniform("ambience"), GameInterface::getAmbience());
+    loadMat4(getUniform("P"), view->proj);
+    loadMat4(getUniform("V"), view->view);
+    loadVec3(getUniform("lightDir"), snapshot.lightDir);
+    loadVec3(getUniform("camPos"), view->position);
+    loadFloat(getUniform("ambience"), snapshot.ambience);
     loadBool(getUniform("allowBloom"), true);
 
     /* Shadows */
@@ -208,15 +210,12 @@ void DiffuseShader::render(const CameraComponent * camera) {
     glBindTexture(GL_TEXTURE_1D, cellSpecularScalesTexture);
     glTexSubImage1D(GL_TEXTURE_1D, 0, 0, int(cellSpecularScales.size()), GL_RED, GL_FLOAT, cellSpecularScales.data());
 
-    /* Get render targets */
-    Vector<DiffuseRenderComponent *> components;
-    RenderSystem::getFrustumComps(camera, components);
-
     /* Iterate through render targets */
-    for (auto drc : components) {
+    for (int i : view->diffuseIs) {
+        const RenderSnapshot::Diffuse & diffuse(snapshot.diffuses[i]);
 
         /* Toon shading */
-        if (showToon && drc->isToon()) {
+        if (showToon && diffuse.isToon) {
             loadBool(getUniform("isToon"), true);
         }
         else {
@@ -224,18 +223,18 @@ void DiffuseShader::render(const CameraComponent * camera) {
         }
 
         /* Tiling amount */
-        loadVec2(getUniform("tiling"), drc->tiling());
+        loadVec2(getUniform("tiling"), diffuse.tiling);
 
         /* Bloom option*/
-        loadBool(getUniform("isNeon"), drc->isNeon());
+        loadBool(getUniform("isNeon"), diffuse.isNeon);
 
         /* Model matrix */
-        loadMat4(getUniform("M"), drc->m_spatial->modelMatrix());
+        loadMat4(getUniform("M"), diffuse.modelMat);
         /* Normal matrix */
-        loadMat3(getUniform("N"), drc->m_spatial->normalMatrix());
+        loadMat3(getUniform("N"), diffuse.normalMat);
 
         /* Bind materials */
-        const ModelTexture modelTexture(drc->modelTexture());
+        const ModelTexture & modelTexture(diffuse.modelTexture);
         loadVec3(getUniform("matDiffuse"), modelTexture.material.diffuse);
         loadVec3(getUniform("matSpecular"), modelTexture.material.specular);
         loadFloat(getUniform("matShine"), modelTexture.material.shine);
@@ -252,7 +251,7 @@ void DiffuseShader::render(const CameraComponent * camera) {
         }
 
         /* Bind mesh */
-        const Mesh & mesh(drc->mesh());
+        const Mesh & mesh(*diffuse.mesh);
         glBindVertexArray(mesh.vaoId);
             
         /* Bind vertex buffer VBO */
@@ -42,7 +42,9 @@ bool HealthShader::init() {
 }
 
 void HealthShader::render(const CameraComponent * camera) {
-    if (!camera || !m_isEnabled) {
+    const RenderSnapshot & snapshot(RenderSystem::snapshot());
+    const RenderSnapshot::View * view(snapshot.view(camera));
+    if (!view || !m_isEnabled) {
         return;
     }
     
@@ -55,27 +57,19 @@ void HealthShader::render(const CameraComponent * camera) {
     glBindBuffer(GL_ARRAY_BUFFER, m_quadVBO);
     glVertexAttribPointer(pos, 3, GL_FLOAT, GL_FALSE, 0, (const void *)0);
 
-    loadMat4(getUniform("P"), camera->getProj());
-    loadMat4(getUniform("V"), camera->getView());
+    loadMat4(getUniform("P"), view->proj);
+    loadMat4(getUniform("V"), view->view);
 
     loadVec2(getUniform("size"), m_size);
 
     /* Iterate through all enemies */
-    auto enemies = Scene::getComponents<EnemyComponent>();
-    for (auto enemy : enemies) {
-        auto health = enemy->gameObject().getComponentByType<HealthComponent>();
-        auto spatials = enemy->gameObject().getComponentsByType<SpatialComponent>();
-        if (!health || spatials.size() < 2) {
-            return;
-        }
-
+    for (const RenderSnapshot::HealthBar & bar : snapshot.healthBars) {
         /* Store health params */
-        loadFloat(getUniform("minVal"), health->minValue());
-        loadFloat(getUniform("curVal"), health->value());
-        loadFloat(getUniform("maxVal"), health->maxValue());
+        loadFloat(getUniform("minVal"), bar.minVal);
+        loadFloat(getUniform("curVal"), bar.curVal);
+        loadFloat(getUniform("maxVal"), bar.maxVal);
 
-        /* Find position based on hierarchy */
-        loadVec3(getUniform("center"), spatials[1]->position() + glm::vec3(0.0f, 0.75f, 0.0f));
+        loadVec3(getUniform("center"), bar.center);
 
         /* Draw */
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
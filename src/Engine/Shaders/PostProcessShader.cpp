@@ -5,8 +5,6 @@
 #include "IO/Window.hpp"
 #include "System/RenderSystem.hpp"
 #include "Component/CameraComponents/CameraComponent.hpp"
-#include "Component/StatComponents/StatComponents.hpp"
-#include "System/GameInterface.hpp"
 
 PostProcessShader::PostProcessShader(const String & vertName, const String & fragName) :
     Shader(vertName, fragName),
@@ -97,21 +95,13 @@ void PostProcessShader::render(const CameraComponent * camera) {
     glUniform1i(getUniform("f_texCol"), 0);
     glUniform1i(getUniform("f_bloomBlur"), 1);
 
-    loadVec3(getUniform("screenTone"), m_screenTone);
+    // as captured, as the scene may be stepping alongside
+    const RenderSnapshot & snapshot(RenderSystem::snapshot());
+    loadVec3(getUniform("screenTone"), snapshot.screenTone);
 
     // Bloom shader does part of UI as well
-    // Get life percentage
-    HealthComponent * hc = GameInterface::getPlayer().getComponentByType<HealthComponent>();
-    float lifePercentage;
-    if (hc) lifePercentage = (hc->value() - hc->minValue()) / (hc->maxValue() - hc->minValue());
-    else lifePercentage = 0.0f;
-    loadFloat(getUniform("lifePercentage"), lifePercentage);
-
-    AmmoComponent * ac = GameInterface::getPlayer().getComponentByType<AmmoComponent>();
-    float ammoPercentage;
-    if (ac) ammoPercentage = (ac->value() - ac->minValue()) / (ac->maxValue() - ac->minValue());
-    else ammoPercentage = 0.0f;
-    loadFloat(getUniform("ammoPercentage"), ammoPercentage);
+    loadFloat(getUniform("lifePercentage"), snapshot.lifePercent);
+    loadFloat(getUniform("ammoPercentage"), snapshot.ammoPercent);
 
     // Draw
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (const void *) 0);
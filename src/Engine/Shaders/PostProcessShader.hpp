@@ -20,6 +20,7 @@ class PostProcessShader : public Shader {
     virtual void render(const CameraComponent * camera) override;
 
     void setScreenTone(const glm::vec3 & tone);
+    const glm::vec3 & screenTone() const { return m_screenTone; }
 
   private:
 
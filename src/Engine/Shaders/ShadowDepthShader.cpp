@@ -140,7 +140,9 @@ void ShadowDepthShader::render(const CameraComponent * camera) {
     glBindFramebuffer(GL_FRAMEBUFFER, s_fboHandle);
     glClear(GL_DEPTH_BUFFER_BIT);
  
-    if (!camera || !m_isEnabled) {
+    const RenderSnapshot & snapshot(RenderSystem::snapshot());
+    const RenderSnapshot::View * view(snapshot.view(camera));
+    if (!view || !m_isEnabled) {
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
         return;
     }
@@ -152,17 +154,16 @@ void ShadowDepthShader::render(const CameraComponent * camera) {
     loadBool(getUniform("particles"), false);
 
     /* Calculate L */
-    this->L = camera->getProj() * camera->getView();
+    this->L = view->proj * view->view;
     loadMat4(getUniform("L"), L);
 
-    Vector<DiffuseRenderComponent *> components;
-    RenderSystem::getFrustumComps(camera, components);
-    for (auto drc : components) {
-    
-        loadMat4(getUniform("M"), drc->m_spatial->modelMatrix());
+    for (int i : view->diffuseIs) {
+        const RenderSnapshot::Diffuse & diffuse(snapshot.diffuses[i]);
+
+        loadMat4(getUniform("M"), diffuse.modelMat);
 
         /* Bind mesh */
-        const Mesh & mesh(drc->mesh());
+        const Mesh & mesh(*diffuse.mesh);
         glBindVertexArray(mesh.vaoId);
             
         /* Bind vertex buffer VBO */
@@ -183,7 +184,7 @@ void ShadowDepthShader::render(const CameraComponent * camera) {
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.eleBufId);
 
         /* Load texture */
-        const ModelTexture modelTexture(drc->modelTexture());
+        const ModelTexture & modelTexture(diffuse.modelTexture);
         if(modelTexture.texture && modelTexture.texture->textureId != 0) {
             loadBool(getUniform("usesTexture"), true);
             loadInt(getUniform("textureImage"), modelTexture.texture->textureId);
@@ -1,6 +1,7 @@
 #include "CollisionSystem.hpp"
 
 #include <algorithm>
+#include <cstdint>
 
 #include "glm/gtx/component_wise.hpp"
 #include "glm/gtx/norm.hpp"
@@ -9,6 +10,7 @@
 #include "Component/CollisionComponents/BounderComponent.hpp"
 #include "Scene/Scene.hpp"
 #include "Util/Octree.hpp"
+#include "Util/ThreadPool.hpp"
 #include "Util/Util.hpp"
 
 
@@ -17,7 +19,35 @@ namespace {
 
 
 
-constexpr float k_rayOffset = 0.001f;
+// bounders whose enclosing boxes have moved less than this reuse their cached contacts
+constexpr float k_pairCacheE = 0.0001f;
+// fewer pairs or rays than these aren't worth handing to another thread
+constexpr int k_minPairsPerChunk = 32;
+constexpr int k_minRaysPerChunk = 64;
+// rays whose positions and directions round to the same multiples of this share cached picks
+constexpr float k_pickCacheQuantum = 0.0001f;
+// dynamic bounders whose enclosing boxes stay within this of where they settled are at rest
+constexpr float k_restE = 0.01f;
+// how many frames a game object must be at rest before it falls asleep
+constexpr int k_sleepFrames = 30;
+
+
+
+// Transformed shapes and enclosing boxes of the bounders, indexed the same as
+// s_bounders, so the narrow phase reads contiguous values instead of calling
+// through each component
+Vector<BounderShape> f_shapes;
+Vector<AABox> f_boxes;
+
+void syncShape(const BounderComponent & bounder) {
+    f_shapes[bounder.index()] = bounder.transShape();
+    f_boxes[bounder.index()] = f_shapes[bounder.index()].enclosingAABox();
+}
+
+void updateBounder(BounderComponent & bounder, float dt) {
+    bounder.update(dt);
+    syncShape(bounder);
+}
 
 
 
@@ -40,42 +70,169 @@ struct Collision {
 
 
 
-bool collide(const BounderComponent & b1, const BounderComponent & b2, UnorderedMap<const BounderComponent *, Vector<std::pair<int, glm::vec3>>> * collisions) {
-    if (b1.weight() == UINT_MAX && b2.weight() == UINT_MAX) {
-        return false;
+// The narrow phase result of a pair of bounders, kept between frames so that
+// pairs at rest don't need to be collided again
+struct PairContact {
+
+    AABox box1, box2; // enclosing boxes of the lower and higher id bounders when last collided
+    glm::vec3 delta; // delta of the lower id bounder
+    bool is; // whether there was a collision
+    bool hasDelta; // whether delta was determined
+    bool isTouched; // whether the pair was tested this frame
+
+    PairContact() :
+        box1(), box2(),
+        delta(),
+        is(false),
+        hasDelta(false),
+        isTouched(false)
+    {}
+
+};
+
+using PairCache = UnorderedMap<uint64_t, PairContact>;
+
+// An adjustment of a bounder due to a collision with a bounder of the given weight
+struct Contact {
+
+    int bounderI;
+    int weight;
+    glm::vec3 delta;
+
+    Contact(int bounderI, int weight, const glm::vec3 & delta) :
+        bounderI(bounderI),
+        weight(weight),
+        delta(delta)
+    {}
+
+};
+
+bool isNear(const AABox & b1, const AABox & b2, float e = k_pairCacheE) {
+    glm::vec3 dMin(glm::abs(b1.min - b2.min)), dMax(glm::abs(b1.max - b2.max));
+    return glm::compMax(glm::max(dMin, dMax)) <= e;
+}
+
+// only bounders that are pushed around by collisions can sleep
+bool canSleep(const BounderComponent & bounder) {
+    return bounder.weight() != 0 && bounder.weight() != UINT_MAX;
+}
+
+// the root of the island containing i, compressing the path along the way
+int findIsland(Vector<int> & parents, int i) {
+    while (parents[i] != i) {
+        parents[i] = parents[parents[i]];
+        i = parents[i];
     }
-    if (!collisions) {
-        return b1.collide(b2, nullptr);
+    return i;
+}
+
+// The narrow phase outcome of a pair of bounders for the current frame
+struct PairResult {
+
+    AABox box1, box2; // enclosing boxes of the first and second bounders
+    glm::vec3 delta; // delta of the first bounder
+    bool isNear; // whether the enclosing boxes intersect
+    bool isCached; // whether the outcome was taken from the cache
+    bool is; // whether there was a collision
+
+};
+
+// whether the pair's collision produces an adjustment
+bool needsDelta(const BounderComponent & b1, const BounderComponent & b2) {
+    return b1.weight() != 0 && b2.weight() != 0;
+}
+
+uint64_t pairKey(const BounderComponent & b1, const BounderComponent & b2) {
+    return b2.id() < b1.id() ?
+        uint64_t(b2.id()) << 32 | uint64_t(b1.id()) :
+        uint64_t(b1.id()) << 32 | uint64_t(b2.id());
+}
+
+// Collides the two bounders, reusing the cached contact of the pair if neither
+// has moved since it was determined
+// Only reads the cache, so may be called from multiple threads at once
+void detPair(const BounderComponent & b1, const BounderComponent & b2, const PairCache & cache, PairResult & r_result) {
+    r_result.box1 = f_boxes[b1.index()];
+    r_result.box2 = f_boxes[b2.index()];
+    r_result.isCached = false;
+    r_result.is = false;
+
+    // enclosing boxes have separated, so there can be no collision
+    r_result.isNear = detail::intersects(r_result.box1, r_result.box2);
+    if (!r_result.isNear) {
+        return;
     }
 
-    if (b1.weight() == 0 || b2.weight() == 0) {
-        bool res(b1.collide(b2, nullptr));
-        if (res) {
-            if (b1.weight() != UINT_MAX) (*collisions)[&b1];
-            if (b2.weight() != UINT_MAX) (*collisions)[&b2];
+    bool isDelta(needsDelta(b1, b2));
+    bool isFlipped(b2.id() < b1.id());
+    auto it(cache.find(pairKey(b1, b2)));
+    if (it != cache.end()) {
+        const PairContact & contact(it->second);
+        const AABox & prevBox1(isFlipped ? contact.box2 : contact.box1);
+        const AABox & prevBox2(isFlipped ? contact.box1 : contact.box2);
+        if ((!isDelta || contact.hasDelta) && isNear(r_result.box1, prevBox1) && isNear(r_result.box2, prevBox2)) {
+            r_result.isCached = true;
+            r_result.is = contact.is;
+            if (isDelta && contact.is) {
+                r_result.delta = isFlipped ? -contact.delta : contact.delta;
+            }
+            return;
         }
-        return res;
     }
-    
-    glm::vec3 delta;
-    if (!b1.collide(b2, &delta)) {
-        return false;
-    }    
+
+    r_result.is = ::collide(f_shapes[b1.index()], f_shapes[b2.index()], isDelta ? &r_result.delta : nullptr);
+}
+
+// Brings the pair's cached contact up to date with its outcome this frame
+void cachePair(const BounderComponent & b1, const BounderComponent & b2, const PairResult & result, PairCache & cache) {
+    uint64_t key(pairKey(b1, b2));
+    if (!result.isNear) {
+        cache.erase(key);
+        return;
+    }
+
+    PairContact & contact(cache[key]);
+    contact.isTouched = true;
+    if (result.isCached) {
+        return;
+    }
+
+    bool isFlipped(b2.id() < b1.id());
+    bool isDelta(needsDelta(b1, b2));
+    contact.is = result.is;
+    contact.box1 = isFlipped ? result.box2 : result.box1;
+    contact.box2 = isFlipped ? result.box1 : result.box2;
+    contact.hasDelta = isDelta;
+    contact.delta = isDelta && result.is ? isFlipped ? -result.delta : result.delta : glm::vec3();
+}
+
+// Non-static bounders that collided are marked in r_collided, and any resulting
+// adjustments are added to r_contacts
+void recordPair(const BounderComponent & b1, const BounderComponent & b2, const PairResult & result, Vector<Contact> & r_contacts, Bitset & r_collided) {
+    if (!needsDelta(b1, b2)) {
+        if (b1.weight() != UINT_MAX) r_collided.set(b1.index());
+        if (b2.weight() != UINT_MAX) r_collided.set(b2.index());
+        return;
+    }
+
+    glm::vec3 delta(result.delta);
     if (b1.weight() < b2.weight()) {
-        (*collisions)[&b1].push_back(std::make_pair(b2.weight(), delta));
-        if (b2.weight() != UINT_MAX) (*collisions)[&b2];
+        r_contacts.emplace_back(b1.index(), b2.weight(), delta);
+        r_collided.set(b1.index());
+        if (b2.weight() != UINT_MAX) r_collided.set(b2.index());
     }
     else if (b2.weight() < b1.weight()) {
-        if (b1.weight() != UINT_MAX) (*collisions)[&b1];
-        (*collisions)[&b2].push_back(std::make_pair(b1.weight(), -delta));
+        if (b1.weight() != UINT_MAX) r_collided.set(b1.index());
+        r_contacts.emplace_back(b2.index(), b1.weight(), -delta);
+        r_collided.set(b2.index());
     }
     else {
         delta *= 0.5f;
-        (*collisions)[&b1].push_back(std::make_pair(b2.weight(), delta));
-        (*collisions)[&b2].push_back(std::make_pair(b1.weight(), -delta));
+        r_contacts.emplace_back(b1.index(), b2.weight(), delta);
+        r_contacts.emplace_back(b2.index(), b1.weight(), -delta);
+        r_collided.set(b1.index());
+        r_collided.set(b2.index());
     }
-
-    return true;
 }
 
 // combines two adjustment deltas such that the maximum of each component is preserved
@@ -97,9 +254,14 @@ glm::vec3 compositeDeltas(const glm::vec3 & d1, const glm::vec3 & d2) {
     return d;
 }
 
-// compares pairs of weight and delta by weight for std::sort
-bool compWeightDelta(const std::pair<int, glm::vec3> & d1, const std::pair<int, glm::vec3> & d2) {
-    return d1.first < d2.first;
+// compares contacts by weight for std::stable_sort
+bool compContactWeight(const Contact & c1, const Contact & c2) {
+    return c1.weight < c2.weight;
+}
+
+// compares contacts by bounder for std::stable_sort
+bool compContactBounder(const Contact & c1, const Contact & c2) {
+    return c1.bounderI < c2.bounderI;
 }
 
 // Computes the net delta from the given deltas mapped by weight
@@ -108,28 +270,29 @@ bool compWeightDelta(const std::pair<int, glm::vec3> & d1, const std::pair<int,
 // weight takes precidence. But this doesn't mean you ignore the lower weight
 // delta. Rather, you "hemispherically clamp" the net lower weight delta
 // onto each higher weight delta, and repeat this process, moving up in weight.
-glm::vec3 detNetDelta(Vector<std::pair<int, glm::vec3>> & weightDeltas) {
-    if (weightDeltas.size() == 0) {
+// Takes the contiguous range of n contacts belonging to a single bounder
+glm::vec3 detNetDelta(Contact * weightDeltas, int n) {
+    if (n == 0) {
         return glm::vec3();
     }
 
-    std::sort(weightDeltas.begin(), weightDeltas.end(), compWeightDelta);
+    std::stable_sort(weightDeltas, weightDeltas + n, compContactWeight);
     
     glm::vec3 net;
-    unsigned int weightI(0);
-    unsigned int i(weightI);
-    unsigned int weight(weightDeltas[weightI].first);
+    int weightI(0);
+    int i(weightI);
+    int weight(weightDeltas[weightI].weight);
     glm::vec3 weightDelta;
-    for (; i < weightDeltas.size() && weightDeltas[i].first == weight; ++i) {
-        weightDelta = compositeDeltas(weightDelta, weightDeltas[i].second);
+    for (; i < n && weightDeltas[i].weight == weight; ++i) {
+        weightDelta = compositeDeltas(weightDelta, weightDeltas[i].delta);
     }
     net = compositeDeltas(net, weightDelta);
     weightI = i;
-    while (weightI < weightDeltas.size()) {
-        weight = weightDeltas[weightI].first;
+    while (weightI < n) {
+        weight = weightDeltas[weightI].weight;
         weightDelta = glm::vec3();
-        for (; i < weightDeltas.size() && weightDeltas[i].first == weight; ++i) {
-            const glm::vec3 & delta(weightDeltas[i].second);
+        for (; i < n && weightDeltas[i].weight == weight; ++i) {
+            const glm::vec3 & delta(weightDeltas[i].delta);
             weightDelta = compositeDeltas(weightDelta, delta);
             net = Util::removeAllAgainst(net, Util::safeNorm(delta));
         }
@@ -140,6 +303,65 @@ glm::vec3 detNetDelta(Vector<std::pair<int, glm::vec3>> & weightDeltas) {
     return net;
 }
 
+// Identifies a pick without a conditional
+struct PickKey {
+
+    glm::ivec3 pos, dir; // quantized ray
+    unsigned int minWeight;
+    float maxDist;
+    unsigned int layers;
+
+    PickKey(const Ray & ray, unsigned int minWeight, float maxDist, unsigned int layers) :
+        pos(glm::round(ray.pos * (1.0f / k_pickCacheQuantum))),
+        dir(glm::round(ray.dir * (1.0f / k_pickCacheQuantum))),
+        minWeight(minWeight),
+        maxDist(maxDist),
+        layers(layers)
+    {}
+
+    bool operator==(const PickKey & o) const {
+        return pos == o.pos && dir == o.dir && minWeight == o.minWeight && maxDist == o.maxDist && layers == o.layers;
+    }
+
+};
+
+struct PickKeyHash {
+
+    size_t operator()(const PickKey & key) const {
+        size_t h(std::hash<unsigned int>()(key.minWeight) ^ std::hash<float>()(key.maxDist) ^ std::hash<unsigned int>()(key.layers));
+        for (int i(0); i < 3; ++i) {
+            h = h * 31 + std::hash<int>()(key.pos[i]);
+            h = h * 31 + std::hash<int>()(key.dir[i]);
+        }
+        return h;
+    }
+
+};
+
+// Results of picks made since the bounders or octree last changed
+UnorderedMap<PickKey, std::pair<const BounderComponent *, Intersect>, PickKeyHash> f_pickCache;
+
+// interleaves the bits of the first 10 bits of each component, which should be in [0, 1]
+uint64_t mortonCode(const glm::vec3 & v) {
+    auto spread([](uint64_t x) {
+        x &= 0x3FF;
+        x = (x | x << 16) & 0x030000FF;
+        x = (x | x <<  8) & 0x0300F00F;
+        x = (x | x <<  4) & 0x030C30C3;
+        x = (x | x <<  2) & 0x09249249;
+        return x;
+    });
+    glm::vec3 q(glm::clamp(v, 0.0f, 1.0f) * 1023.0f);
+    return spread(uint64_t(q.x)) | spread(uint64_t(q.y)) << 1 | spread(uint64_t(q.z)) << 2;
+}
+
+// transfers the state of bit `from` to bit `to`, and unsets `from`
+void moveBit(Bitset & bits, int from, int to) {
+    if (bits.test(from)) bits.set(to);
+    else bits.reset(to);
+    bits.reset(from);
+}
+
 
 
 }
@@ -147,19 +369,38 @@ glm::vec3 detNetDelta(Vector<std::pair<int, glm::vec3>> & weightDeltas) {
 
 
 const Vector<BounderComponent *> & CollisionSystem::s_bounderComponents(Scene::getComponents<BounderComponent>());
-UnorderedSet<BounderComponent *> CollisionSystem::s_potentials;
-UnorderedSet<const BounderComponent *> CollisionSystem::s_collided;
-UnorderedSet<const BounderComponent *> CollisionSystem::s_adjusted;
+Vector<BounderComponent *> CollisionSystem::s_bounders;
+Bitset CollisionSystem::s_potentials;
+Bitset CollisionSystem::s_collided;
+Bitset CollisionSystem::s_adjusted;
+Bitset CollisionSystem::s_awake;
+Bitset CollisionSystem::s_asleep;
 UniquePtr<Octree<const BounderComponent *>> CollisionSystem::s_octree;
+UniquePtr<ThreadPool> CollisionSystem::s_threadPool;
+bool CollisionSystem::s_isPickCaching = false;
+CollisionStats CollisionSystem::s_stats;
 int CollisionSystem::s_nPicks = 0;
+int CollisionSystem::s_nPickCacheHits = 0;
+int CollisionSystem::s_nPickCacheMisses = 0;
 
 void CollisionSystem::init() {
+    s_threadPool = UniquePtr<ThreadPool>::make();
+
     auto compAddedCallback(
         [&](const Message & msg_) {
             const ComponentAddedMessage & msg(static_cast<const ComponentAddedMessage &>(msg_));            
             if (msg.typeI == typeid(BounderComponent)) {
                 BounderComponent & bounder(static_cast<BounderComponent &>(msg.comp));
-                s_potentials.insert(&bounder);
+                f_pickCache.clear();
+                bounder.m_index = int(s_bounders.size());
+                s_bounders.push_back(&bounder);
+                f_shapes.emplace_back();
+                f_boxes.emplace_back();
+                syncShape(bounder);
+                s_potentials.set(bounder.m_index);
+                if (canSleep(bounder)) {
+                    s_awake.set(bounder.m_index);
+                }
             }
         }
     );
@@ -170,8 +411,42 @@ void CollisionSystem::init() {
             const ComponentRemovedMessage & msg(static_cast<const ComponentRemovedMessage &>(msg_));            
             if (msg.typeI == typeid(BounderComponent)) {
                 BounderComponent & bounder(const_cast<BounderComponent &>(static_cast<const BounderComponent &>(*msg.comp)));
-                s_potentials.erase(&bounder);
                 if (s_octree) s_octree->remove(&bounder);
+                f_pickCache.clear();
+                if (bounder.m_index < 0) {
+                    return;
+                }
+                // anything asleep on or against the bounder needs to notice it's gone
+                if (s_octree && bounder.weight() != 0 && s_asleep.any()) {
+                    static Vector<const BounderComponent *> s_nearby;
+                    s_nearby.clear();
+                    s_octree->filter(f_boxes[bounder.m_index], s_nearby);
+                    // game objects killed this frame have already let go of
+                    // their components, and have nothing to wake
+                    const GameObject * removedObj(bounder.gameObjectIfAlive());
+                    for (const BounderComponent * other : s_nearby) {
+                        const GameObject * otherObj(other->gameObjectIfAlive());
+                        if (otherObj && otherObj != removedObj && other->m_index >= 0 && s_asleep.test(other->m_index)) {
+                            wake(*otherObj);
+                        }
+                    }
+                }
+                // swap the last bounder into the removed bounder's slot
+                int i(bounder.m_index), lastI(int(s_bounders.size()) - 1);
+                BounderComponent * last(s_bounders[lastI]);
+                s_bounders[i] = last;
+                last->m_index = i;
+                s_bounders.pop_back();
+                f_shapes[i] = f_shapes[lastI];
+                f_shapes.pop_back();
+                f_boxes[i] = f_boxes[lastI];
+                f_boxes.pop_back();
+                moveBit(s_potentials, lastI, i);
+                moveBit(s_collided, lastI, i);
+                moveBit(s_adjusted, lastI, i);
+                moveBit(s_awake, lastI, i);
+                moveBit(s_asleep, lastI, i);
+                bounder.m_index = -1;
             }
         }
     );
@@ -180,231 +455,392 @@ void CollisionSystem::init() {
     auto spatTransformCallback(
         [&](const Message & msg_) {
             const SpatialChangeMessage & msg(static_cast<const SpatialChangeMessage &>(msg_));
-            for (auto & comp : msg.spatial.gameObject().getComponentsByType<BounderComponent>()) {
-                BounderComponent & bounder(static_cast<BounderComponent &>(*comp));
-                s_potentials.insert(&bounder);
-            }
+            spatialMoved(msg.spatial);
         }
     );
     Scene::addReceiver<SpatialChangeMessage>(nullptr, spatTransformCallback);
+
+    // physics moves its bodies silently and sends them all at once
+    auto spatsMovedCallback(
+        [&](const Message & msg_) {
+            const SpatialsMovedMessage & msg(static_cast<const SpatialsMovedMessage &>(msg_));
+            for (int i(0); i < msg.nSpatials; ++i) {
+                spatialMoved(*msg.spatials[i]);
+            }
+        }
+    );
+    Scene::addReceiver<SpatialsMovedMessage>(nullptr, spatsMovedCallback);
+}
+
+void CollisionSystem::spatialMoved(const SpatialComponent & spatial) {
+    for (auto & comp : spatial.gameObject().getComponentsByType<BounderComponent>()) {
+        BounderComponent & bounder(static_cast<BounderComponent &>(*comp));
+        if (bounder.m_index < 0) {
+            continue;
+        }
+        if (s_asleep.test(bounder.m_index)) {
+            // the game object is only woken if it actually moved, not
+            // for the settling adjustment made as it fell asleep
+            updateBounder(bounder, 0.0f);
+            // it's moved in the octree now, not at the next collision update
+            f_pickCache.clear();
+            if (!isNear(f_boxes[bounder.m_index], bounder.m_restBox, k_restE)) {
+                wake(bounder.gameObject());
+            }
+        }
+        else {
+            s_potentials.set(bounder.m_index);
+        }
+    }
+}
+
+int CollisionSystem::gameObjectIndex(const GameObject & gameObject) {
+    int index(-1);
+    for (const BounderComponent * bounder : gameObject.getComponentsByType<BounderComponent>()) {
+        if (bounder->m_index >= 0 && (index < 0 || bounder->m_index < index)) {
+            index = bounder->m_index;
+        }
+    }
+    return index;
 }
 
 void CollisionSystem::update(float dt) {
-    static UnorderedMap<const BounderComponent *, Vector<std::pair<int, glm::vec3>>> s_collisions;
-    static UnorderedSet<const BounderComponent *> s_criticals;
-    static UnorderedSet<const BounderComponent *> s_criticalZeroes;
+    static Vector<Contact> s_contacts;
+    static Bitset s_criticals;
+    static Bitset s_criticalZeroes;
     static Vector<const BounderComponent *> s_yanked;
-    static Vector<const BounderComponent *> s_passed;
-    static UnorderedSet<const BounderComponent *> s_checked;
-    static UnorderedMap<const GameObject *, glm::vec3> s_gameObjectDeltas;
+    static Vector<std::pair<const BounderComponent *, Intersect>> s_sweepHits;
+    static Bitset s_checked;
+    // game object deltas are indexed by the game object's lowest bounder index
+    static Vector<glm::vec3> s_gameObjectDeltas;
+    static Bitset s_hasGameObjectDelta;
     static Vector<const BounderComponent *> s_octreeResults;
-    static UnorderedSet<GameObject *> s_outOfBounds;
+    static Bitset s_outOfBounds;
+    static PairCache s_pairCache;
+    static Vector<std::pair<const BounderComponent *, const BounderComponent *>> s_pairs;
+    static Vector<PairResult> s_pairResults;
+    static Vector<std::pair<int, int>> s_islandPairs; // touching game objects
+    static Vector<int> s_islandParents;
+    static Bitset s_inIsland;
+    static Bitset s_restless;
+    static Bitset s_drowsy;
 
     s_nPicks = 0;
+    s_nPickCacheHits = 0;
+    s_nPickCacheMisses = 0;
+    s_stats = CollisionStats();
+    if (s_octree) s_octree->resetVisits();
+    Util::Stopwatch watch;
+    // bounders are about to change
+    f_pickCache.clear();
+
+    s_gameObjectDeltas.resize(s_bounders.size());
 
     // update all potential bounders
-    for (BounderComponent * bounder : s_potentials) {
-        bounder->update(dt);
-    }
+    s_potentials.forEach([&](int i) {
+        updateBounder(*s_bounders[i], dt);
+    });
+    s_stats.updateDT = float(watch.lap());
 
     // update octree
     if (s_octree) {
         s_outOfBounds.clear();
-        for (BounderComponent * bounder : s_potentials) {
-            if (!s_octree->set(bounder, bounder->enclosingAABox())) {
-                s_outOfBounds.insert(&bounder->gameObject());
+        s_potentials.forEach([&](int i) {
+            BounderComponent * bounder(s_bounders[i]);
+            if (!s_octree->set(bounder, f_boxes[i], bounder->m_layer)) {
+                s_outOfBounds.set(gameObjectIndex(bounder->gameObject()));
             }
-        }
+        });
         // remove all out of bounds game objects
-        for (GameObject * go : s_outOfBounds) {
-            const auto & bounders(go->getComponentsByType<BounderComponent>());
-            for (BounderComponent * bounder : bounders) {
-                s_potentials.erase(bounder);
+        s_outOfBounds.forEach([&](int i) {
+            GameObject & go(s_bounders[i]->gameObject());
+            for (BounderComponent * bounder : go.getComponentsByType<BounderComponent>()) {
+                s_potentials.reset(bounder->m_index);
             }
-            Scene::destroyGameObject(*go);
-        }
+            Scene::destroyGameObject(go);
+        });
     }
+    s_stats.treeDT = float(watch.lap());
 
     // determine all bounders with path intersections
     s_criticals.clear();
     s_criticalZeroes.clear();
-    for (BounderComponent * bounder : s_potentials) {
+    s_potentials.forEach([&](int i) {
+        const BounderComponent * bounder(s_bounders[i]);
         if (bounder->isCritical()) {
-            s_criticals.insert(bounder);
-            if (bounder->weight() == 0) s_criticalZeroes.insert(bounder);
+            ++s_stats.nCriticals;
+            s_criticals.set(i);
+            if (bounder->weight() == 0) s_criticalZeroes.set(i);
         }
-    }
+    });
+    // do not intersect other critical bounders. critical-critical collision hella unsupported
+    auto nonCritical([&](const BounderComponent & b) {
+        return !s_criticals.test(b.m_index);
+    });
     // determine path intersection corrections per game object
-    s_gameObjectDeltas.clear();
-    for (const BounderComponent * bounder : s_criticals) {
+    s_hasGameObjectDelta.clear();
+    s_criticals.forEach([&](int i) {
+        const BounderComponent * bounder(s_bounders[i]);
         if (bounder->weight() == 0) {
-            continue;
+            return;
         }
-        glm::vec3 delta(bounder->center() - bounder->prevCenter());
-        float dist(glm::length(delta));
-        Ray ray(bounder->prevCenter(), delta / dist);
-        auto pair(pickHeavy(
-            ray,
-            1,
-            // do not intersect other critical bounders. critical-critical collision hella unsupported
-            [&](const BounderComponent & b) {
-                return s_criticals.count(&b) == 0;
+        s_sweepHits.clear();
+        sweep(*bounder, nonCritical, s_sweepHits);
+        for (const auto & hit : s_sweepHits) {
+            if (hit.first->weight() >= 1) {
+                int goI(gameObjectIndex(bounder->gameObject()));
+                glm::vec3 & d(s_gameObjectDeltas[goI]);
+                if (s_hasGameObjectDelta.set(goI)) d = glm::vec3();
+                d = compositeDeltas(d, hit.second.pos - bounder->center());
+                break;
             }
-        ));
-        Intersect & inter(pair.second);
-        if (inter.is && inter.dist * inter.dist < dist * dist) {
-            glm::vec3 & d(s_gameObjectDeltas[&bounder->gameObject()]);
-            d = compositeDeltas(d, pair.second.pos - bounder->center());
         }
-    }
+    });
     // apply path intersection corrections
     s_yanked.clear();
-    for (auto & pair : s_gameObjectDeltas) {
-        if (pair.second == glm::vec3()) {
-            continue;
+    s_hasGameObjectDelta.forEach([&](int goI) {
+        if (s_gameObjectDeltas[goI] == glm::vec3()) {
+            return;
         }
-        const GameObject & go(*pair.first);
+        const GameObject & go(s_bounders[goI]->gameObject());
         SpatialComponent & spat(*go.getSpatial());
-        spat.move(pair.second, true);
+        spat.move(s_gameObjectDeltas[goI], true);
+        ++s_stats.nAdjustments;
         for (BounderComponent * bounder : go.getComponentsByType<BounderComponent>()) {
             s_yanked.push_back(bounder);
-            s_potentials.insert(bounder);
-            bounder->update(dt);
+            s_potentials.set(bounder->m_index);
+            updateBounder(*bounder, dt);
             if (s_octree) {
-                s_octree->set(bounder, bounder->enclosingAABox());
+                s_octree->set(bounder, f_boxes[bounder->m_index], bounder->m_layer);
             }
         }
-    }
+    });
     // look for path collisions with 0 weight bounders
     for (const BounderComponent * bounder : s_yanked) {
-        glm::vec3 delta(bounder->center() - bounder->prevCenter());
-        float dist(glm::length(delta));
-        Ray ray(bounder->prevCenter(), delta / dist);
-        s_passed.clear();
-        pickHeavy(
-            ray,
-            1,
-            // do not intersect other critical bounders. critical-critical collision hella unsupported
-            [&](const BounderComponent & b) {
-                return s_criticals.count(&b) == 0;
-            },
-            &s_passed,
-            dist
-        );
-        for (const BounderComponent * b : s_passed) {
+        s_sweepHits.clear();
+        sweep(*bounder, nonCritical, s_sweepHits);
+        for (const auto & hit : s_sweepHits) {
+            const BounderComponent * b(hit.first);
+            if (b->weight() >= 1) {
+                break;
+            }
             Scene::sendMessage<CollisionMessage>(&bounder->gameObject(), *bounder, *b);
             Scene::sendMessage<CollisionMessage>(&b->gameObject(), *b, *bounder);
         }
     }
     // process 0 weight criticals
-    for (const BounderComponent * bounder : s_criticalZeroes) {
-        glm::vec3 delta(bounder->center() - bounder->prevCenter());
-        float dist(glm::length(delta));
-        Ray ray(bounder->prevCenter(), delta / dist);
-        s_passed.clear();
-        pickAll(
-            ray,
-            // do not intersect other critical bounders. critical-critical collision hella unsupported
-            [&](const BounderComponent & b) {
-                return s_criticals.count(&b) == 0;
-            },
-            &s_passed,
-            dist
-        );
-        for (const BounderComponent * b : s_passed) {
+    s_criticalZeroes.forEach([&](int i) {
+        const BounderComponent * bounder(s_bounders[i]);
+        s_sweepHits.clear();
+        sweep(*bounder, nonCritical, s_sweepHits);
+        for (const auto & hit : s_sweepHits) {
+            const BounderComponent * b(hit.first);
             Scene::sendMessage<CollisionMessage>(&bounder->gameObject(), *bounder, *b);
             Scene::sendMessage<CollisionMessage>(&b->gameObject(), *b, *bounder);
         }
-    }    
+    });
+    s_stats.criticalDT = float(watch.lap());
 
-    // gather all collisions
+    // gather all potentially colliding pairs
     s_collided.clear();
     s_adjusted.clear();
     s_checked.clear();
-    for (BounderComponent * bounder : s_potentials) {
+    s_pairs.clear();
+    s_potentials.forEach([&](int i) {
+        BounderComponent * bounder(s_bounders[i]);
         s_octreeResults.clear();
-        s_checked.insert(bounder);
-        const Vector<const BounderComponent *> * possible(&reinterpret_cast<const Vector<const BounderComponent *> &>(s_bounderComponents));
+        s_checked.set(i);
+        const Vector<const BounderComponent *> * possible(&reinterpret_cast<const Vector<const BounderComponent *> &>(s_bounders));
         if (s_octree) {
-            s_octree->filter(bounder, s_octreeResults);
+            s_octree->filter(bounder, s_octreeResults, bounder->m_mask);
             possible = &s_octreeResults;
         }
+        s_stats.nCandidates += int(possible->size());
         for (const BounderComponent * other : *possible) {
-            if (s_checked.count(other) || &other->gameObject() == &bounder->gameObject()) {
+            if (s_checked.test(other->m_index) || &other->gameObject() == &bounder->gameObject()) {
                 continue;
             }
-            if (collide(*bounder, *other, &s_collisions)) {
-                Scene::sendMessage<CollisionMessage>(&bounder->gameObject(), *bounder, *other);
-                Scene::sendMessage<CollisionMessage>(&other->gameObject(), *other, *bounder);
+            if (!bounder->collidesWith(*other) || (bounder->weight() == UINT_MAX && other->weight() == UINT_MAX)) {
+                continue;
+            }
+            s_pairs.emplace_back(bounder, other);
+        }
+    });
+    s_potentials.clear();
+    s_stats.gatherDT = float(watch.lap());
+
+    // collide pairs across threads. Each chunk writes only its own range of
+    // results and the cache is only read, so no synchronization is needed
+    s_stats.nPairs = int(s_pairs.size());
+    s_pairResults.resize(s_pairs.size());
+    s_threadPool->parallelFor(int(s_pairs.size()), k_minPairsPerChunk, [&](int begin, int end) {
+        for (int i(begin); i < end; ++i) {
+            detPair(*s_pairs[i].first, *s_pairs[i].second, s_pairCache, s_pairResults[i]);
+        }
+    });
+
+    // merge results in pair order so that contacts and messages are deterministic
+    for (int i(0); i < int(s_pairs.size()); ++i) {
+        const BounderComponent & b1(*s_pairs[i].first), & b2(*s_pairs[i].second);
+        const PairResult & result(s_pairResults[i]);
+        cachePair(b1, b2, result, s_pairCache);
+        if (result.isCached) {
+            ++s_stats.nCachedPairs;
+        }
+        else if (result.isNear) {
+            int t1(int(b1.shapeType())), t2(int(b2.shapeType()));
+            ++s_stats.nNarrowPhase[std::min(t1, t2)][std::max(t1, t2)];
+        }
+        if (result.is) {
+            ++s_stats.nHits;
+            recordPair(b1, b2, result, s_contacts, s_collided);
+            Scene::sendMessage<CollisionMessage>(&b1.gameObject(), b1, b2);
+            Scene::sendMessage<CollisionMessage>(&b2.gameObject(), b2, b1);
+            // a moving bounder wakes whatever it runs into
+            if (s_asleep.test(b2.m_index) && b1.weight() != 0 && b1.m_restFrames == 0) {
+                wake(b2.gameObject());
+            }
+            else if (s_asleep.test(b1.m_index) && b2.weight() != 0 && b2.m_restFrames == 0) {
+                wake(b1.gameObject());
+            }
+            if (canSleep(b1) && canSleep(b2)) {
+                s_islandPairs.emplace_back(gameObjectIndex(b1.gameObject()), gameObjectIndex(b2.gameObject()));
             }
         }
     }
-    s_potentials.clear(); 
-    
+
+    // evict pairs that weren't tested this frame. Pairs at rest are still tested
+    // each frame, so this only drops pairs that are no longer near each other
+    for (auto it(s_pairCache.begin()); it != s_pairCache.end(); ) {
+        if (it->second.isTouched) {
+            it->second.isTouched = false;
+            ++it;
+        }
+        else {
+            it = s_pairCache.erase(it);
+        }
+    }
+
     // composite deltas into a single delta per game object
     // additionally send norm messages
-    s_gameObjectDeltas.clear();
-    for (auto & pair : s_collisions) {
-        const BounderComponent & bounder(*pair.first);
-        auto & weightDeltas(pair.second);
-        s_collided.insert(&bounder);
-        // there was an adjustment
-        if (weightDeltas.size()) {
-            for (auto & weightDelta : weightDeltas) { // send norm messages
-                Scene::sendMessage<CollisionNormMessage>(&bounder.gameObject(), bounder, Util::safeNorm(weightDelta.second));
-            }
-            glm::vec3 & gameObjectDelta(s_gameObjectDeltas[&bounder.gameObject()]);
-            gameObjectDelta = compositeDeltas(gameObjectDelta, detNetDelta(weightDeltas));
+    // contacts are grouped by bounder so each bounder's are contiguous
+    std::stable_sort(s_contacts.begin(), s_contacts.end(), compContactBounder);
+    s_hasGameObjectDelta.clear();
+    for (int i(0); i < int(s_contacts.size()); ) {
+        const BounderComponent & bounder(*s_bounders[s_contacts[i].bounderI]);
+        int n(1);
+        while (i + n < int(s_contacts.size()) && s_contacts[i + n].bounderI == s_contacts[i].bounderI) {
+            ++n;
+        }
+        for (int j(i); j < i + n; ++j) { // send norm messages
+            Scene::sendMessage<CollisionNormMessage>(&bounder.gameObject(), bounder, Util::safeNorm(s_contacts[j].delta));
         }
+        int goI(gameObjectIndex(bounder.gameObject()));
+        glm::vec3 & gameObjectDelta(s_gameObjectDeltas[goI]);
+        if (s_hasGameObjectDelta.set(goI)) gameObjectDelta = glm::vec3();
+        gameObjectDelta = compositeDeltas(gameObjectDelta, detNetDelta(s_contacts.data() + i, n));
+        ++s_stats.nNetDeltas;
+        i += n;
     }
-    s_collisions.clear();
+    s_contacts.clear();
 
     // apply deltas to game objects
-    for (auto & pair : s_gameObjectDeltas) {
-        const GameObject * gameObject(pair.first);
+    s_hasGameObjectDelta.forEach([&](int goI) {
+        const GameObject * gameObject(&s_bounders[goI]->gameObject());
         SpatialComponent & spat(*gameObject->getSpatial());
-        const glm::vec3 & delta(pair.second);
+        const glm::vec3 & delta(s_gameObjectDeltas[goI]);
         // set position rather than move because they are conceptually different
         // this will come into play if we do time step interpolation
         spat.move(delta, true);
+        ++s_stats.nAdjustments;
         for (Component * comp : gameObject->getComponentsByType<BounderComponent>()) {
             BounderComponent * bounder(static_cast<BounderComponent *>(comp));
-            s_potentials.insert(bounder);
-            bounder->update(dt);
+            s_potentials.set(bounder->m_index);
+            updateBounder(*bounder, dt);
             if (s_octree) {
-                s_octree->set(bounder, bounder->enclosingAABox());
+                s_octree->set(bounder, f_boxes[bounder->m_index], bounder->m_layer);
             }
-            s_adjusted.insert(bounder);
+            s_adjusted.set(bounder->m_index);
             Scene::sendMessage<CollisionAdjustMessage>(gameObject, *gameObject, delta);
         }
+    });
+
+    // count how long each awake dynamic bounder has stayed put
+    s_drowsy.clear();
+    s_awake.forEach([&](int i) {
+        BounderComponent & bounder(*s_bounders[i]);
+        const AABox & box(f_boxes[i]);
+        if (!isNear(box, bounder.m_restBox, k_restE)) {
+            bounder.m_restBox = box;
+            bounder.m_restFrames = 0;
+        }
+        else if (++bounder.m_restFrames >= k_sleepFrames) {
+            s_drowsy.set(gameObjectIndex(bounder.gameObject()));
+        }
+    });
+    // touching game objects form islands that only fall asleep together, so
+    // that the parts of a settled pile don't keep waking each other
+    if (s_drowsy.any()) {
+        s_islandParents.resize(s_bounders.size());
+        s_inIsland.clear();
+        for (const auto & pair : s_islandPairs) {
+            if (s_inIsland.set(pair.first)) s_islandParents[pair.first] = pair.first;
+            if (s_inIsland.set(pair.second)) s_islandParents[pair.second] = pair.second;
+            int root1(findIsland(s_islandParents, pair.first)), root2(findIsland(s_islandParents, pair.second));
+            if (root1 != root2) {
+                s_islandParents[std::max(root1, root2)] = std::min(root1, root2);
+            }
+        }
+        s_restless.clear();
+        s_inIsland.forEach([&](int goI) {
+            if (!isRested(s_bounders[goI]->gameObject())) {
+                s_restless.set(findIsland(s_islandParents, goI));
+            }
+        });
+        s_drowsy.forEach([&](int goI) {
+            const GameObject & go(s_bounders[goI]->gameObject());
+            if (s_inIsland.test(goI) && s_restless.test(findIsland(s_islandParents, goI))) {
+                return;
+            }
+            if (isRested(go)) {
+                sleep(go);
+            }
+        });
     }
+    s_islandPairs.clear();
+
+    // anything cached while updating may be stale
+    f_pickCache.clear();
+    s_stats.resolveDT = float(watch.lap());
 }
 
-std::pair<const BounderComponent *, Intersect> CollisionSystem::pick(const Ray & ray) {
-    return pick(ray, [](const BounderComponent & bounder) { return true; });
+std::pair<const BounderComponent *, Intersect> CollisionSystem::pick(const Ray & ray, unsigned int layers) {
+    return pickHeavy(ray, 0, nullptr, Util::infinity(), layers);
 }
 
 std::pair<const BounderComponent *, Intersect> CollisionSystem::pick(const Ray & ray, const std::function<bool(const BounderComponent &)> & conditional) {
-    static Vector<BounderComponent *> s_octreeResults;
-
     ++s_nPicks;
 
+    return pickUncounted(ray, conditional);
+}
+
+std::pair<const BounderComponent *, Intersect> CollisionSystem::pickUncounted(const Ray & ray, const std::function<bool(const BounderComponent &)> & conditional, unsigned int layers) {
     if (s_octree) {
-        return s_octree->filter(ray, [& conditional](const Ray & ray, const BounderComponent * bounder) {
-            if (conditional(*bounder)) {
-                Intersect inter(bounder->intersect(ray));
+        return s_octree->filter(ray, [& conditional, layers](const Ray & ray, const BounderComponent * bounder) {
+            if ((bounder->m_layer & layers) && conditional(*bounder)) {
+                Intersect inter(::intersect(ray, f_shapes[bounder->m_index]));
                 if (inter.face) {
                     return inter;
                 }
             }
             return Intersect();
-        });
+        }, layers);
     }
     else {
         BounderComponent * bounder(nullptr);
         Intersect inter;
         for (BounderComponent * b : s_bounderComponents) {
-            if (!conditional(*b)) {
+            if (!(b->m_layer & layers) || !conditional(*b)) {
                 continue;
             }
             Intersect potential(b->intersect(ray));
@@ -424,9 +860,39 @@ std::pair<const BounderComponent *, Intersect> CollisionSystem::pickHeavy(
     const Ray & ray,
     unsigned int minWeight,
     Vector<const BounderComponent *> * r_passed,
-    float maxDist
+    float maxDist,
+    unsigned int layers
 ) {
-    return pickHeavy(ray, minWeight, [](const BounderComponent & bounder) { return true; }, r_passed, maxDist);
+    if (r_passed) {
+        return pickMany(
+            ray,
+            [layers](const BounderComponent & bounder) { return (bounder.m_layer & layers) != 0; },
+            [minWeight](const BounderComponent & bounder) { return bounder.weight() >= minWeight; },
+            *r_passed,
+            maxDist,
+            layers
+        );
+    }
+
+    PickKey key(ray, minWeight, maxDist, layers);
+    if (s_isPickCaching) {
+        auto it(f_pickCache.find(key));
+        if (it != f_pickCache.end()) {
+            ++s_nPickCacheHits;
+            return it->second;
+        }
+        ++s_nPickCacheMisses;
+    }
+
+    ++s_nPicks;
+    auto pair(pickUncounted(ray, [minWeight](const BounderComponent & bounder) { return bounder.weight() >= minWeight; }, layers));
+    if (pair.second.dist > maxDist) {
+        pair = std::pair<const BounderComponent *, Intersect>{};
+    }
+    if (s_isPickCaching) {
+        f_pickCache.emplace(key, pair);
+    }
+    return pair;
 }
 
 std::pair<const BounderComponent *, Intersect> CollisionSystem::pickHeavy(
@@ -446,22 +912,7 @@ std::pair<const BounderComponent *, Intersect> CollisionSystem::pickHeavy(
         }
     }
     
-    Ray ray(ray_);
-    float distRemaining(maxDist);
-    while (distRemaining > 0.0f) {
-        auto pair(pick(ray, conditional));
-        Intersect & inter(pair.second);
-
-        if (!inter.is || inter.dist > distRemaining || pair.first->weight() >= minWeight) {
-            break;
-        }
-
-        r_passed->push_back(pair.first);
-        ray.pos = inter.pos + k_rayOffset * ray.dir;
-        distRemaining -= inter.dist;
-    }
-
-    return std::pair<const BounderComponent *, Intersect>{};
+    return pickMany(ray_, conditional, [&](const BounderComponent & bounder) { return bounder.weight() >= minWeight; }, *r_passed, maxDist);
 }
 
 std::pair<const BounderComponent *, Intersect> CollisionSystem::pickAll(
@@ -488,36 +939,240 @@ std::pair<const BounderComponent *, Intersect> CollisionSystem::pickAll(
         }
     }
     
-    Ray ray(ray_);
-    float distRemaining(maxDist);
-    while (distRemaining > 0.0f) {
-        auto pair(pick(ray, conditional));
-        Intersect & inter(pair.second);
+    return pickMany(ray_, conditional, [](const BounderComponent & bounder) { return false; }, *r_passed, maxDist);
+}
 
-        if (!inter.is || inter.dist > distRemaining) {
-           break;
+std::pair<const BounderComponent *, Intersect> CollisionSystem::pickMany(
+    const Ray & ray,
+    const std::function<bool(const BounderComponent &)> & conditional,
+    const std::function<bool(const BounderComponent &)> & stop,
+    Vector<const BounderComponent *> & r_passed,
+    float maxDist,
+    unsigned int layers
+) {
+    static Vector<std::pair<const BounderComponent *, Intersect>> s_hits;
+
+    ++s_nPicks;
+
+    auto intersectFace([&](const Ray & ray, const BounderComponent * bounder) {
+        if (conditional(*bounder)) {
+            Intersect inter(::intersect(ray, f_shapes[bounder->m_index]));
+            if (inter.face) {
+                return inter;
+            }
         }
+        return Intersect();
+    });
 
-        r_passed->push_back(pair.first);
-        ray.pos = inter.pos + k_rayOffset * ray.dir;
-        distRemaining -= inter.dist;
+    s_hits.clear();
+    if (s_octree) {
+        s_octree->filter(ray, intersectFace, [&](const BounderComponent * bounder) { return stop(*bounder); }, maxDist, s_hits, layers);
+    }
+    else {
+        for (const BounderComponent * bounder : s_bounders) {
+            Intersect inter(intersectFace(ray, bounder));
+            if (inter.is && inter.dist <= maxDist) {
+                s_hits.emplace_back(bounder, inter);
+            }
+        }
+        std::stable_sort(s_hits.begin(), s_hits.end(), [](const std::pair<const BounderComponent *, Intersect> & h1, const std::pair<const BounderComponent *, Intersect> & h2) {
+            return h1.second.dist < h2.second.dist;
+        });
     }
 
+    for (const auto & hit : s_hits) {
+        if (stop(*hit.first)) {
+            return hit;
+        }
+        r_passed.push_back(hit.first);
+    }
     return std::pair<const BounderComponent *, Intersect>{};
 }
 
+void CollisionSystem::pickBatch(
+    const Vector<Ray> & rays,
+    unsigned int minWeight,
+    Vector<std::pair<const BounderComponent *, Intersect>> & r_results,
+    float maxDist,
+    unsigned int layers
+) {
+    static Vector<std::pair<uint64_t, int>> s_order;
+
+    int n(int(rays.size()));
+    r_results.resize(n);
+    if (!n) {
+        return;
+    }
+    s_nPicks += n;
+
+    // order rays by direction octant and then by morton code of their position
+    // so that rays near each other in the order traverse the same nodes
+    glm::vec3 min(rays.front().pos), max(rays.front().pos);
+    for (const Ray & ray : rays) {
+        min = glm::min(min, ray.pos);
+        max = glm::max(max, ray.pos);
+    }
+    glm::vec3 invSpan(1.0f / glm::max(max - min, glm::vec3(1.0e-6f)));
+    s_order.resize(n);
+    for (int i(0); i < n; ++i) {
+        const Ray & ray(rays[i]);
+        uint64_t octant((ray.dir.x < 0.0f ? 1 : 0) | (ray.dir.y < 0.0f ? 2 : 0) | (ray.dir.z < 0.0f ? 4 : 0));
+        s_order[i].first = octant << 32 | mortonCode((ray.pos - min) * invSpan);
+        s_order[i].second = i;
+    }
+    std::sort(s_order.begin(), s_order.end());
+
+    // the octree is not changed until this returns, so workers can share it
+    auto conditional([minWeight](const BounderComponent & bounder) { return bounder.weight() >= minWeight; });
+    s_threadPool->parallelFor(n, k_minRaysPerChunk, [&](int begin, int end) {
+        for (int i(begin); i < end; ++i) {
+            int rayI(s_order[i].second);
+            auto pair(pickUncounted(rays[rayI], conditional, layers));
+            r_results[rayI] = pair.second.dist <= maxDist ? pair : std::pair<const BounderComponent *, Intersect>{};
+        }
+    });
+}
+
+void CollisionSystem::sweep(
+    const BounderComponent & bounder,
+    const std::function<bool(const BounderComponent &)> & conditional,
+    Vector<std::pair<const BounderComponent *, Intersect>> & r_hits
+) {
+    static Vector<const BounderComponent *> s_octreeResults;
+
+    glm::vec3 delta(bounder.center() - bounder.prevCenter());
+    float dist(glm::length(delta));
+    if (dist == 0.0f) {
+        return;
+    }
+
+    glm::vec3 dir(Util::safeNorm(delta));
+    if (dir == glm::vec3()) {
+        return;
+    }
+    BounderShape prevShape(bounder.prevTransShape());
+    size_t prevSize(r_hits.size());
+    auto sweepAgainst([&](const BounderComponent & other) {
+        if (&other == &bounder || !bounder.collidesWith(other) || &other.gameObject() == &bounder.gameObject() || !conditional(other)) {
+            return;
+        }
+        Intersect inter(::sweep(prevShape, dir, f_shapes[other.m_index]));
+        if (inter.is && inter.face && inter.dist <= dist) {
+            r_hits.emplace_back(&other, inter);
+        }
+    });
+
+    if (s_octree) {
+        // the region covered by the bounder over the course of the sweep
+        const AABox & box(f_boxes[bounder.m_index]);
+        AABox region(glm::min(box.min, box.min - delta), glm::max(box.max, box.max - delta));
+        s_octreeResults.clear();
+        s_octree->filter(region, s_octreeResults, bounder.m_mask);
+        s_stats.nCandidates += int(s_octreeResults.size());
+        for (const BounderComponent * other : s_octreeResults) {
+            sweepAgainst(*other);
+        }
+    }
+    else {
+        s_stats.nCandidates += int(s_bounders.size());
+        for (const BounderComponent * other : s_bounders) {
+            sweepAgainst(*other);
+        }
+    }
+
+    std::stable_sort(r_hits.begin() + prevSize, r_hits.end(), [](const std::pair<const BounderComponent *, Intersect> & h1, const std::pair<const BounderComponent *, Intersect> & h2) {
+        return h1.second.dist < h2.second.dist;
+    });
+}
+
+void CollisionSystem::layerChanged(BounderComponent & bounder) {
+    if (bounder.m_index < 0) {
+        return;
+    }
+    if (s_octree) {
+        s_octree->set(&bounder, f_boxes[bounder.m_index], bounder.m_layer);
+    }
+    f_pickCache.clear();
+}
+
+bool CollisionSystem::isRested(const GameObject & gameObject) {
+    for (const BounderComponent * bounder : gameObject.getComponentsByType<BounderComponent>()) {
+        if (s_awake.test(bounder->m_index) && bounder->m_restFrames < k_sleepFrames) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void CollisionSystem::sleep(const GameObject & gameObject) {
+    for (const BounderComponent * bounder : gameObject.getComponentsByType<BounderComponent>()) {
+        if (s_awake.test(bounder->m_index)) {
+            s_awake.reset(bounder->m_index);
+            s_asleep.set(bounder->m_index);
+            s_potentials.reset(bounder->m_index);
+        }
+    }
+    Scene::sendMessage<SleepMessage>(&gameObject, gameObject);
+}
+
+void CollisionSystem::wake(const GameObject & gameObject) {
+    bool wasAsleep(false);
+    for (BounderComponent * bounder : gameObject.getComponentsByType<BounderComponent>()) {
+        if (s_asleep.test(bounder->m_index)) {
+            s_asleep.reset(bounder->m_index);
+            s_awake.set(bounder->m_index);
+            s_potentials.set(bounder->m_index);
+            bounder->m_restFrames = 0;
+            wasAsleep = true;
+        }
+    }
+    if (wasAsleep) {
+        Scene::sendMessage<WakeMessage>(&gameObject, gameObject);
+    }
+}
+
+void CollisionSystem::wakeAll() {
+    s_asleep.forEach([&](int i) {
+        // bounders of killed game objects linger until they're removed
+        if (const GameObject * obj = s_bounders[i]->gameObjectIfAlive()) {
+            wake(*obj);
+        }
+    });
+}
+
+bool CollisionSystem::isAsleep(const BounderComponent & bounder) {
+    return s_asleep.test(bounder.m_index);
+}
+
+const CollisionStats & CollisionSystem::stats() {
+    if (s_octree) {
+        s_stats.nRegionVisits = s_octree->nVisits(Octree<const BounderComponent *>::Query::region);
+        s_stats.nElementVisits = s_octree->nVisits(Octree<const BounderComponent *>::Query::element);
+        s_stats.nNearestRayVisits = s_octree->nVisits(Octree<const BounderComponent *>::Query::nearestRay);
+        s_stats.nAllRayVisits = s_octree->nVisits(Octree<const BounderComponent *>::Query::allRay);
+    }
+    return s_stats;
+}
+
+void CollisionSystem::setPickCaching(bool caching) {
+    s_isPickCaching = caching;
+    f_pickCache.clear();
+}
+
 void CollisionSystem::setOctree(const glm::vec3 & min, const glm::vec3 & max, float minCellSize) {
+    f_pickCache.clear();
     s_octree = UniquePtr<Octree<const BounderComponent *>>::make(AABox(min, max), minCellSize);
     for (BounderComponent * bounder : s_bounderComponents) {
-        s_octree->set(bounder, bounder->enclosingAABox());
+        s_octree->set(bounder, bounder->enclosingAABox(), bounder->m_layer);
     }
 }
 
 void CollisionSystem::remakeOctree() {
+    f_pickCache.clear();
     if (s_octree) {
         s_octree->clear();
         for (BounderComponent * bounder : s_bounderComponents) {
-            s_octree->set(bounder, bounder->enclosingAABox());
+            s_octree->set(bounder, bounder->enclosingAABox(), bounder->m_layer);
         }
     }
 }
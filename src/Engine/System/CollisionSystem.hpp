@@ -5,6 +5,8 @@
 #include <functional>
 
 #include "System.hpp"
+#include "Component/CollisionComponents/BounderComponent.hpp"
+#include "Util/Bitset.hpp"
 #include "Util/Geometry.hpp"
 #include "Util/Memory.hpp"
 
@@ -14,16 +16,46 @@ class Scene;
 class BounderComponent;
 class BounderShader;
 template <typename T> class Octree;
+class ThreadPool;
 class OctreeShader;
 class Mesh;
 class GameObject;
 
 
 
+// Counts and timings of the last collision update. Octree visits and
+// candidates also include the queries made since, such as picks and sweeps
+struct CollisionStats {
+
+    // octree nodes visited by each kind of query
+    int nRegionVisits = 0; // sweeps
+    int nElementVisits = 0; // broad phase
+    int nNearestRayVisits = 0; // picks
+    int nAllRayVisits = 0; // picks passing through bounders
+    int nCandidates = 0; // bounders returned by the broad phase and sweep queries
+    int nPairs = 0; // pairs given to the narrow phase
+    int nCachedPairs = 0; // of which reused their cached contact
+    int nNarrowPhase[BounderShape::k_nTypes][BounderShape::k_nTypes] = {}; // narrow phase tests by shape types, lower type first
+    int nHits = 0; // colliding pairs
+    int nCriticals = 0; // critical bounders swept
+    int nAdjustments = 0; // game objects moved apart, including critical corrections
+    int nNetDeltas = 0; // detNetDelta calls
+    // seconds spent in each phase
+    float updateDT = 0.0f; // updating bounders
+    float treeDT = 0.0f; // refreshing the octree
+    float criticalDT = 0.0f; // sweeping critical bounders
+    float gatherDT = 0.0f; // gathering potential pairs
+    float resolveDT = 0.0f; // narrow phase, adjustments, and sleeping
+
+};
+
+
+
 // static class
 class CollisionSystem {
 
     friend Scene;
+    friend BounderComponent;
     friend BounderShader;
     friend OctreeShader;
 
@@ -34,15 +66,20 @@ class CollisionSystem {
     static void update(float dt);
 
     // Casts a ray and returns the first bounder hit and its intersection
-    static std::pair<const BounderComponent *, Intersect> pick(const Ray & ray);
+    // Picks without a conditional or r_passed may be served from the pick
+    // cache, see setPickCaching
+    // Only bounders on the given layers are considered
+    static std::pair<const BounderComponent *, Intersect> pick(const Ray & ray, unsigned int layers = BounderComponent::k_allLayers);
     // Only bounders which pass the conditional are considered
     static std::pair<const BounderComponent *, Intersect> pick(const Ray & ray, const std::function<bool(const BounderComponent &)> & conditional);
     // Ray will pass through bounders with weight less than specified and store them in r_passed, if not null
+    // Returns the first bounder with at least the specified weight, if any
     static std::pair<const BounderComponent *, Intersect> pickHeavy(
         const Ray & ray,
         unsigned int minWeight,
         Vector<const BounderComponent *> * r_passed = nullptr,
-        float maxDist = std::numeric_limits<float>::infinity()
+        float maxDist = std::numeric_limits<float>::infinity(),
+        unsigned int layers = BounderComponent::k_allLayers
     );
     static std::pair<const BounderComponent *, Intersect> pickHeavy(
         const Ray & ray,
@@ -64,6 +101,43 @@ class CollisionSystem {
         float maxDist = std::numeric_limits<float>::infinity()
     );
 
+    // Sweeps the bounder from its previous to its current position and stores
+    // each bounder it touches along the way in r_hits, sorted by distance.
+    // Takes a single pass over the bounders in the swept region
+    // Only bounders it collides with which pass the conditional are considered
+    static void sweep(
+        const BounderComponent & bounder,
+        const std::function<bool(const BounderComponent &)> & conditional,
+        Vector<std::pair<const BounderComponent *, Intersect>> & r_hits
+    );
+
+    // Casts each ray as pickHeavy would without r_passed, storing the results
+    // in r_results in the same order as the rays. The rays are reordered for
+    // coherence and spread across worker threads
+    static void pickBatch(
+        const Vector<Ray> & rays,
+        unsigned int minWeight,
+        Vector<std::pair<const BounderComponent *, Intersect>> & r_results,
+        float maxDist = std::numeric_limits<float>::infinity(),
+        unsigned int layers = BounderComponent::k_allLayers
+    );
+
+    // When enabled, the results of picks without a conditional or r_passed are
+    // remembered until the bounders next change, and identical picks reuse them.
+    // Rays are compared after rounding, so nearly identical rays share results
+    static void setPickCaching(bool caching);
+
+    // Dynamic game objects that stay at rest for long enough fall asleep. Their
+    // bounders are no longer updated or tested against until they are moved,
+    // hit by a moving bounder, or explicitly woken
+    static void wake(const GameObject & gameObject);
+    // such as when gravity changes
+    static void wakeAll();
+
+    static bool isAsleep(const BounderComponent & bounder);
+
+    static const CollisionStats & stats();
+
     static void setOctree(const glm::vec3 & min, const glm::vec3 & max, float minCellSize);
 
     static void remakeOctree();
@@ -83,14 +157,53 @@ class CollisionSystem {
 
     private:
 
+    // pick without counting toward s_nPicks. Only reads collision state, so
+    // may be called from multiple threads at once
+    static std::pair<const BounderComponent *, Intersect> pickUncounted(const Ray & ray, const std::function<bool(const BounderComponent &)> & conditional, unsigned int layers = BounderComponent::k_allLayers);
+
+    // Walks the ray once, storing every bounder hit in r_passed in order until
+    // one passes stop, which is returned
+    static std::pair<const BounderComponent *, Intersect> pickMany(
+        const Ray & ray,
+        const std::function<bool(const BounderComponent &)> & conditional,
+        const std::function<bool(const BounderComponent &)> & stop,
+        Vector<const BounderComponent *> & r_passed,
+        float maxDist,
+        unsigned int layers = BounderComponent::k_allLayers
+    );
+
+    // keeps the octree's layer summaries accurate
+    static void layerChanged(BounderComponent & bounder);
+
+    // the lowest index of the game object's bounders
+    static int gameObjectIndex(const GameObject & gameObject);
+
+    // marks the bounders of the spatial's game object to be tested, or
+    // updates them in place and wakes them if they're asleep
+    static void spatialMoved(const SpatialComponent & spatial);
+
+    // whether all of the game object's awake dynamic bounders have been at rest long enough to sleep
+    static bool isRested(const GameObject & gameObject);
+
+    static void sleep(const GameObject & gameObject);
+
     static const Vector<BounderComponent *> & s_bounderComponents;
-    static UnorderedSet<BounderComponent *> s_potentials;
-    static UnorderedSet<const BounderComponent *> s_collided;
-    static UnorderedSet<const BounderComponent *> s_adjusted;
+    static Vector<BounderComponent *> s_bounders; // dense, indexed by BounderComponent::index
+    // per-frame state, indexed by BounderComponent::index
+    static Bitset s_potentials;
+    static Bitset s_collided;
+    static Bitset s_adjusted;
+    static Bitset s_awake; // dynamic bounders that may fall asleep
+    static Bitset s_asleep;
     static UniquePtr<Octree<const BounderComponent *>> s_octree;
+    static UniquePtr<ThreadPool> s_threadPool;
+    static bool s_isPickCaching;
+    static CollisionStats s_stats;
 
     public:
 
     static int s_nPicks;
+    static int s_nPickCacheHits;
+    static int s_nPickCacheMisses;
 
 };
\ No newline at end of file
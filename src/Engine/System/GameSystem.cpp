@@ -60,6 +60,7 @@ void GameSystem::Player::init() {
     Scene::addComponent<GroundComponent>(*gameObject);
     Capsule playerCap(glm::vec3(0.0f, -k_height * 0.5f + k_width, 0.0f), k_width, k_height - 2.0f * k_width);
     bounder = &Scene::addComponentAs<CapsuleBounderComponent, BounderComponent>(*gameObject, k_weight, playerCap);
+    bounder->setLayer(BounderComponent::k_playerLayer);
     camera = &Scene::addComponent<CameraComponent>(*gameObject, k_fov, k_near, k_far, headSpatial);
     controller = &Scene::addComponent<PlayerControllerComponent>(*gameObject, k_lookSpeed, k_moveSpeed, k_jumpSpeed, k_sprintSpeed);
     playerComp = &Scene::addComponent<PlayerComponent>(*gameObject);
@@ -103,6 +104,8 @@ void GameSystem::Enemies::Basic::create(const glm::vec3 & position, const float
     NewtonianComponent & newtComp(Scene::addComponent<NewtonianComponent>(obj, false));
     BounderComponent & bodyBoundComp(CollisionSystem::addBounderFromMesh(obj, k_weight, *bodyMesh, false, false, true));
     BounderComponent & headBoundComp(CollisionSystem::addBounderFromMesh(obj, k_weight, *headMesh, false, true, false, &headSpatComp));
+    bodyBoundComp.setLayer(BounderComponent::k_enemyLayer);
+    headBoundComp.setLayer(BounderComponent::k_enemyLayer);
     if (mapping)
         MapExploreComponent & mapComp(Scene::addComponent<MapExploreComponent>(obj, 0.0f, Scene::mapFilename));
     else {
@@ -137,7 +140,7 @@ void GameSystem::Enemies::Basic::spawn() {
     if (dir == glm::vec3()) {
         return;
     }
-    auto pair(CollisionSystem::pickHeavy(Ray(Player::bodySpatial->position(), dir), UINT_MAX));
+    auto pair(CollisionSystem::pickHeavy(Ray(Player::bodySpatial->position(), dir), UINT_MAX, nullptr, Util::infinity(), BounderComponent::k_staticLayer));
     Intersect & inter(pair.second);
     if (inter.dist > 20.0f) {
         create(Player::bodySpatial->position() + dir * 20.0f, k_moveSpeed, k_maxHP);
@@ -153,6 +156,12 @@ void GameSystem::Enemies::killAll() {
     }
 }
 
+void GameSystem::Enemies::preload() {
+    Loader::getMesh(Basic::k_bodyMeshName);
+    Loader::getMesh(Basic::k_headMeshName);
+    Loader::getTexture(Basic::k_textureName);
+}
+
 void GameSystem::Enemies::enablePathfinding() {
     for (EnemyComponent * comp : s_enemyComponents) {
         GameObject & enemy(comp->gameObject());
@@ -290,6 +299,7 @@ GameObject * GameSystem::Weapons::PizzaSlice::fire(const glm::vec3 & initPos, co
     GameObject & obj(Scene::createGameObject());
     SpatialComponent & spatComp(Scene::addComponent<SpatialComponent>(obj, initPos, k_scale, orient));
     BounderComponent & bounderComp(CollisionSystem::addBounderFromMesh(obj, k_weight, *mesh, false, true, false));
+    bounderComp.setLayer(BounderComponent::k_projectileLayer);
     NewtonianComponent & newtComp(Scene::addComponent<NewtonianComponent>(obj, true));
     GroundComponent & groundComp(Scene::addComponent<GroundComponent>(obj));
     newtComp.addVelocity(initDir * k_speed + srcVel);
@@ -319,8 +329,8 @@ GameObject * GameSystem::Weapons::PizzaSlice::fireFromPlayer() {
 }
 
 void GameSystem::Weapons::PizzaSlice::equip() {
-    const Mesh * mesh(Loader::getMesh("weapons/Pizza_Slice.obj"));
-    const Texture * tex(Loader::getTexture("weapons/Pizza_Tex.png"));
+    const Mesh * mesh(Loader::getMesh(k_meshName));
+    const Texture * tex(Loader::getTexture(k_texName));
     ModelTexture modelTex(tex);
     Player::handDiffuse = &Scene::addComponent<DiffuseRenderComponent>(*Player::gameObject,
         *Player::handSpatial,
@@ -364,6 +374,7 @@ GameObject * GameSystem::Weapons::SodaGrenade::fire(const glm::vec3 & initPos, c
     GameObject & obj(Scene::createGameObject());
     SpatialComponent & spatComp(Scene::addComponent<SpatialComponent>(obj, initPos, k_scale, Player::headSpatial->orientation()));
     BounderComponent & bounderComp(CollisionSystem::addBounderFromMesh(obj, k_weight, *mesh, false, true, false));
+    bounderComp.setLayer(BounderComponent::k_projectileLayer);
     NewtonianComponent & newtComp(Scene::addComponent<NewtonianComponent>(obj, true));
     GroundComponent & groundComp(Scene::addComponent<GroundComponent>(obj));
     Scene::addComponentAs<GravityComponent, AcceleratorComponent>(obj);
@@ -394,8 +405,8 @@ GameObject * GameSystem::Weapons::SodaGrenade::fireFromPlayer() {
 }
 
 void GameSystem::Weapons::SodaGrenade::equip() {
-    const Mesh * mesh(Loader::getMesh("weapons/SodaCan.obj"));
-    const Texture * tex(Loader::getTexture("weapons/SodaCan_Tex.png"));
+    const Mesh * mesh(Loader::getMesh(k_meshName));
+    const Texture * tex(Loader::getTexture(k_texName));
     ModelTexture modelTex(tex);
     Player::handDiffuse = &Scene::addComponent<DiffuseRenderComponent>(*Player::gameObject,
         *Player::handSpatial,
@@ -422,6 +433,8 @@ void GameSystem::Weapons::SodaGrenade::unequip() {
 //------------------------------------------------------------------------------
 // Sriracha Bottle
 
+const String GameSystem::Weapons::SrirachaBottle::k_meshName = "weapons/Sriracha.obj";
+const String GameSystem::Weapons::SrirachaBottle::k_texName = "weapons/Sriracha_Tex.png";
 const float GameSystem::Weapons::SrirachaBottle::k_damage = 100.0f;
 const float GameSystem::Weapons::SrirachaBottle::k_radius = 1.5f;
 const float GameSystem::Weapons::SrirachaBottle::k_ammo = 10.0f; // seconds
@@ -460,8 +473,8 @@ void GameSystem::Weapons::SrirachaBottle::updatePlayers(float dt) {
 }
 
 void GameSystem::Weapons::SrirachaBottle::equip() {
-    const Mesh * mesh(Loader::getMesh("weapons/Sriracha.obj"));
-    const Texture * tex(Loader::getTexture("weapons/Sriracha_Tex.png"));
+    const Mesh * mesh(Loader::getMesh(k_meshName));
+    const Texture * tex(Loader::getTexture(k_texName));
     ModelTexture modelTex(tex);
     Player::handDiffuse = &Scene::addComponent<DiffuseRenderComponent>(*Player::gameObject,
         *Player::handSpatial,
@@ -503,6 +516,15 @@ void GameSystem::Weapons::destroyAllWeapons() {
     }
 }
 
+void GameSystem::Weapons::preload() {
+    Loader::getMesh(PizzaSlice::k_meshName);
+    Loader::getTexture(PizzaSlice::k_texName);
+    Loader::getMesh(SodaGrenade::k_meshName);
+    Loader::getTexture(SodaGrenade::k_texName);
+    Loader::getMesh(SrirachaBottle::k_meshName);
+    Loader::getTexture(SrirachaBottle::k_texName);
+}
+
 
 
 //==============================================================================
@@ -816,6 +838,11 @@ void GameSystem::init() {
     // Init Shops
     Shops::init();
 
+    // Enemies and weapons are spawned mid simulation, which may be off the GL
+    // thread, so their assets are loaded now
+    Enemies::preload();
+    Weapons::preload();
+
     // Set message callbacks
     setupMessageCallbacks();
     
@@ -1144,6 +1171,11 @@ void GameSystem::setupMessageCallbacks() {
             s_gravity *= -1.0f;
             SpatialSystem::setGravity(-SpatialSystem::gravity());
         }
+        else {
+            return;
+        }
+        // things at rest won't otherwise notice
+        CollisionSystem::wakeAll();
     });
     Scene::addReceiver<KeyMessage>(nullptr, gravCallback);
 
@@ -1195,14 +1227,37 @@ void GameSystem::setupImGui() {
             ImGui::Text("          Game: %5.2f%%, %5.2f%%", Scene::         gameDT * factor, Scene::         gameMessagingDT * factor);
             ImGui::Text("   Pathfinding: %5.2f%%, %5.2f%%", Scene::  pathfindingDT * factor, Scene::  pathfindingMessagingDT * factor);
             ImGui::Text("       Spatial: %5.2f%%, %5.2f%%", Scene::      spatialDT * factor, Scene::      spatialMessagingDT * factor);
+            ImGui::Text("     Transform: %5.2f%%", Scene::transformDT * factor);
             ImGui::Text("     Collision: %5.2f%%, %5.2f%%", Scene::    collisionDT * factor, Scene::    collisionMessagingDT * factor);
             ImGui::Text("Post Collision: %5.2f%%, %5.2f%%", Scene::postCollisionDT * factor, Scene::postCollisionMessagingDT * factor);
             ImGui::Text("      Particle: %5.2f%%, %5.2f%%", Scene::     particleDT * factor, Scene::              particleDT * factor);
-            ImGui::Text("        Render: %5.2f%%, %5.2f%%", Scene::       renderDT * factor, Scene::       renderMessagingDT * factor);
+            ImGui::Text("       Capture: %5.2f%%, %5.2f%%", Scene::      captureDT * factor, Scene::       renderMessagingDT * factor);
+            ImGui::Text("        Render: %5.2f%%", Scene::renderDT * factor);
             ImGui::Text("         Sound: %5.2f%%, %5.2f%%", Scene::        soundDT * factor, Scene::        soundMessagingDT * factor);
             ImGui::Text("    Kill Queue: %5.2f%%", Scene::killDT * factor);
             ImGui::NewLine();
             ImGui::Text("# Picks: %d", CollisionSystem::s_nPicks);
+            ImGui::Text("Pick Cache: %d hits, %d misses", CollisionSystem::s_nPickCacheHits, CollisionSystem::s_nPickCacheMisses);
+            ImGui::Text("Pending Paths: %d", PathfindingSystem::nPendingPaths());
+            ImGui::NewLine();
+            const CollisionStats & collisionStats(CollisionSystem::stats());
+            ImGui::Text("Collision Phases (ms)");
+            ImGui::Text("      Update: %6.3f", collisionStats.    updateDT * 1000.0f);
+            ImGui::Text("        Tree: %6.3f", collisionStats.      treeDT * 1000.0f);
+            ImGui::Text("    Critical: %6.3f", collisionStats.  criticalDT * 1000.0f);
+            ImGui::Text("      Gather: %6.3f", collisionStats.    gatherDT * 1000.0f);
+            ImGui::Text("     Resolve: %6.3f", collisionStats.   resolveDT * 1000.0f);
+            ImGui::Text("Octree Visits");
+            ImGui::Text("      Region: %d", collisionStats.nRegionVisits);
+            ImGui::Text("     Element: %d", collisionStats.nElementVisits);
+            ImGui::Text(" Nearest Ray: %d", collisionStats.nNearestRayVisits);
+            ImGui::Text("     All Ray: %d", collisionStats.nAllRayVisits);
+            ImGui::Text("Candidates: %d, Pairs: %d (%d cached), Hits: %d", collisionStats.nCandidates, collisionStats.nPairs, collisionStats.nCachedPairs, collisionStats.nHits);
+            ImGui::Text("Narrow Phase (box, sphere, capsule, mesh)");
+            for (const auto & row : collisionStats.nNarrowPhase) {
+                ImGui::Text("    %7d %7d %7d %7d", row[0], row[1], row[2], row[3]);
+            }
+            ImGui::Text("Criticals: %d, Adjustments: %d, Net Deltas: %d", collisionStats.nCriticals, collisionStats.nAdjustments, collisionStats.nNetDeltas);
             ImGui::NewLine();
             ImGui::Text("Game Objects: %d", Scene::getGameObjects().size());
             ImGui::Text("Components");
@@ -101,6 +101,9 @@ class GameSystem {
 
         static void killAll();
 
+        // Loads every enemy's meshes and textures
+        static void preload();
+
         static void enablePathfinding();
 
         static void disablePathfinding();
@@ -186,6 +189,8 @@ class GameSystem {
 
         struct SrirachaBottle {
 
+            static const String k_meshName;
+            static const String k_texName;
             static const float k_damage;
             static const float k_radius;
             static const float k_ammo;
@@ -206,6 +211,9 @@ class GameSystem {
 
         static void destroyAllWeapons();
 
+        // Loads every weapon's mesh and texture
+        static void preload();
+
     };
 
     //--------------------------------------------------------------------------
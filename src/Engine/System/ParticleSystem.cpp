@@ -12,6 +12,21 @@
 
 
 
+namespace {
+
+const String k_goreMeshName = "particles/Gore_Chunk.obj";
+const String k_dropletMeshName = "particles/Droplet.obj";
+const String k_sodaMeshName = "particles/Soda_2.obj";
+const String k_goreTexName = "particles/Gore_Chunk_Tex.png";
+const String k_waterTexName = "particles/Water_Drop_Tex.png";
+const String k_sodaTexName = "particles/Soda_Tex.png";
+const String k_bloodTexName = "particles/Blood_Drop_Tex.png";
+const String k_sparkleTexName = "particles/Sparkle_Tex.png";
+
+}
+
+
+
 const int ParticleSystem::k_maxNParticles = 8192;
 const int ParticleSystem::k_maxVariations = 20; // if changed, need to change diffuse shader and shadow shader
 const float ParticleSystem::k_minScaleFactor = 0.5f;
@@ -31,6 +46,15 @@ void ParticleSystem::init() {
         s_variationMs[i] = Util::compositeTransform(scaleVec, glm::rotate(angle, axis));
         s_variationNs[i] = glm::mat3(s_variationMs.back()) * glm::mat3(glm::scale(glm::mat4(), 1.0f / scaleVec));
     }
+
+    // Effects are added mid simulation, which may be off the GL thread, so
+    // everything they use is loaded now
+    for (const String * meshName : {&k_goreMeshName, &k_dropletMeshName, &k_sodaMeshName}) {
+        Loader::getMesh(*meshName);
+    }
+    for (const String * texName : {&k_goreTexName, &k_waterTexName, &k_sodaTexName, &k_bloodTexName, &k_sparkleTexName}) {
+        Loader::getTexture(*texName);
+    }
 }
 
 void ParticleSystem::update(float dt) {
@@ -48,8 +72,8 @@ ParticleComponent & ParticleSystem::addBodyExplosionPC(SpatialComponent & spatia
     bool randomDistrib(true); 
     auto initializer(UniquePtr<SphereParticleInitializer>::make(minSpeed, maxSpeed, randomDistrib));
     auto updater(UniquePtr<GravityParticleUpdater>::make());
-    Mesh & mesh(*Loader::getMesh("particles/Gore_Chunk.obj"));
-    ModelTexture modelTexture(Loader::getTexture("particles/Gore_Chunk_Tex.png"));
+    Mesh & mesh(*Loader::getMesh(k_goreMeshName));
+    ModelTexture modelTexture(Loader::getTexture(k_goreTexName));
     int maxN(100);
     float rate(0.0f);
     float duration(1.0f);
@@ -80,8 +104,8 @@ ParticleComponent & ParticleSystem::addWaterFountainPC(SpatialComponent & spatia
     bool randomDistrib(true);
     auto initializer(UniquePtr<ConeParticleInitializer>::make(minSpeed, maxSpeed, angle, randomDistrib));
     auto updater(UniquePtr<GravityParticleUpdater>::make());
-    Mesh & mesh(*Loader::getMesh("particles/Droplet.obj"));
-    ModelTexture modelTexture(Loader::getTexture("particles/Water_Drop_Tex.png"));
+    Mesh & mesh(*Loader::getMesh(k_dropletMeshName));
+    ModelTexture modelTexture(Loader::getTexture(k_waterTexName));
     int maxN(2000);
     float rate(1000.0f);
     float duration(2.0f);
@@ -111,7 +135,7 @@ ParticleComponent & ParticleSystem::addSodaGrenadePC(SpatialComponent & spatial)
     bool randomDistrib(true);
     auto initializer(UniquePtr<SphereParticleInitializer>::make(minSpeed, maxSpeed, randomDistrib));
     auto updater(UniquePtr<AttenuationParticleUpdater>::make(5.0f));
-    Mesh & mesh(*Loader::getMesh("particles/Soda_2.obj"));
+    Mesh & mesh(*Loader::getMesh(k_sodaMeshName));
     int maxN(500);
     float rate(4000.0f);
     float duration(0.25f);
@@ -119,7 +143,7 @@ ParticleComponent & ParticleSystem::addSodaGrenadePC(SpatialComponent & spatial)
     float scale(1.0f);
     bool variation(false);
     bool fade(true);
-    ModelTexture modelTexture(Loader::getTexture("particles/Soda_Tex.png"));
+    ModelTexture modelTexture(Loader::getTexture(k_sodaTexName));
     return Scene::addComponent<ParticleComponent>(spatial.gameObject(),
         std::move(initializer),
         std::move(updater),
@@ -143,8 +167,8 @@ ParticleComponent & ParticleSystem::addSrirachaPC(SpatialComponent & spatial) {
     bool randomDistrib(true);
     auto initializer(UniquePtr<ConeParticleInitializer>::make(minSpeed, maxSpeed, angle, randomDistrib));
     auto updater(UniquePtr<LinearParticleUpdater>::make());
-    Mesh & mesh(*Loader::getMesh("particles/Droplet.obj"));
-    ModelTexture modelTexture(Loader::getTexture("particles/Blood_Drop_Tex.png"));
+    Mesh & mesh(*Loader::getMesh(k_dropletMeshName));
+    ModelTexture modelTexture(Loader::getTexture(k_bloodTexName));
     int maxN(2000);
     float rate(2000.0f);
     float duration(0.5f);
@@ -175,8 +199,8 @@ ParticleComponent & ParticleSystem::addTwinklePC(SpatialComponent & spatial) {
     bool randomDistrib(true);
     auto initializer(UniquePtr<ConeParticleInitializer>::make(minSpeed, maxSpeed, angle, randomDistrib));
     auto updater(UniquePtr<LinearParticleUpdater>::make());
-    Mesh & mesh(*Loader::getMesh("particles/Droplet.obj"));
-    ModelTexture modelTexture(Loader::getTexture("particles/Sparkle_Tex.png"));
+    Mesh & mesh(*Loader::getMesh(k_dropletMeshName));
+    ModelTexture modelTexture(Loader::getTexture(k_sparkleTexName));
     int maxN(2000);
     float rate(100.0f);
     float duration(3.0f);
@@ -2,70 +2,183 @@
 
 #include "Scene/Scene.hpp"
 #include "Component/PathfindingComponents/PathfindingComponent.hpp"
-#include <fstream>
-#include <sstream>
+#include "Component/SpatialComponents/SpatialComponent.hpp"
+#include "Component/CollisionComponents/BounderComponent.hpp"
+#include "System/CollisionSystem.hpp"
+#include "Util/Util.hpp"
+#include <algorithm>
 
-// Init graph
-PathfindingSystem::vecvectorMap PathfindingSystem::graph = PathfindingSystem::vecvectorMap();
+namespace {
+
+const String k_graphFileName = "../resources/smallMap.txt";
+
+}
+
+
+
+constexpr float PathfindingSystem::k_halfStairs;
+constexpr uint32_t PathfindingSystem::k_fieldRadius;
+constexpr double PathfindingSystem::k_defPathBudget;
 
 const Vector<PathfindingComponent *> & PathfindingSystem::s_pathfindingComponents(Scene::getComponents<PathfindingComponent>());
+NavGraph PathfindingSystem::s_graph;
+NavHierarchy PathfindingSystem::s_hierarchy;
+bool PathfindingSystem::s_isHierarchyLoaded(false);
+NavSearch PathfindingSystem::s_search;
+Vector<uint32_t> PathfindingSystem::s_nodePath;
+UnorderedMap<const GameObject *, PathfindingSystem::Target> PathfindingSystem::s_targets;
+Vector<PathfindingSystem::PathRequest> PathfindingSystem::s_requests;
+int PathfindingSystem::s_nextRequestI(0);
+unsigned int PathfindingSystem::s_nextRequestId(0);
+double PathfindingSystem::s_pathBudget(k_defPathBudget);
+Vector<glm::vec3> PathfindingSystem::s_requestPath;
 
 void PathfindingSystem::init() {
 
-    // Read in the graph of the map from a text file
-    readInGraph("../resources/smallMap.txt", graph);
+    // Read in the graph of the map
+    readInGraph(k_graphFileName, s_graph);
 }
 
 void PathfindingSystem::update(float dt) {
+    // requests made during this update wait for the next
+    solveRequests();
+
+    for (auto & target : s_targets) {
+        target.second.isCurrent = false;
+    }
+
     for (auto & comp : s_pathfindingComponents) {
         comp->update(dt);
     }
 }
 
-// Read in the graph from a specified file and fill out the vecToNode map
-void PathfindingSystem::readInGraph(String fileName, vecvectorMap &graph) {
-    std::ifstream myfile(fileName.c_str());
-    std::string line;
+void PathfindingSystem::buildGraph(const vecvectorMap & map, NavGraph & r_graph) {
+    Vector<glm::vec3> positions;
+    Vector<Vector<glm::vec3>> neighbors;
+    positions.reserve(map.size());
+    neighbors.reserve(map.size());
+    for (const auto & node : map) {
+        positions.push_back(node.first);
+        neighbors.push_back(node.second);
+    }
+    r_graph.build(positions, neighbors);
+}
 
-    if (myfile.is_open()) {
-        while (getline(myfile, line)) {
-            std::istringstream iss(line);
-            std::string token;
-            float x, y, z;
+uint32_t PathfindingSystem::nearestNode(const NavGraph & graph, const glm::vec3 & pos) {
+    return graph.nearest(pos, k_halfStairs);
+}
 
-            std::getline(iss, token, ',');
-            x = std::stof(token);
+bool PathfindingSystem::findPath(const NavGraph & graph, const glm::vec3 & start, const glm::vec3 & goal, Vector<glm::vec3> & r_path) {
+    r_path.clear();
+    if (!s_search.findPath(graph, nearestNode(graph, start), nearestNode(graph, goal), s_nodePath)) {
+        return false;
+    }
+    for (uint32_t node : s_nodePath) {
+        r_path.push_back(graph.position(node));
+    }
+    return true;
+}
 
-            std::getline(iss, token, ',');
-            y = std::stof(token);
+bool PathfindingSystem::findLevelPath(const glm::vec3 & start, const glm::vec3 & goal, Vector<glm::vec3> & r_path) {
+    r_path.clear();
+    if (!levelHierarchy().findPath(s_graph, nearestNode(s_graph, start), nearestNode(s_graph, goal), s_nodePath)) {
+        return false;
+    }
+    for (uint32_t node : s_nodePath) {
+        r_path.push_back(s_graph.position(node));
+    }
+    return true;
+}
 
-            std::getline(iss, token, ',');
-            z = std::stof(token);
+String PathfindingSystem::navFileName(const String & graphFileName) {
+    return NavGraph::withExtension(graphFileName, ".nav");
+}
 
-            glm::vec3 nodePos = glm::vec3(x, y, z);
+String PathfindingSystem::zonesFileName(const String & graphFileName) {
+    return NavGraph::withExtension(graphFileName, ".zones");
+}
 
-            Vector<glm::vec3> neighbors = Vector<glm::vec3>();
+const PathfindingSystem::Target & PathfindingSystem::target(const GameObject & gameObject) {
+    Target & target(s_targets[&gameObject]);
+    if (target.isCurrent) {
+        return target;
+    }
 
-            while (std::getline(iss, token, ',')) {
-                int pos = token.find("vec3");
-                if (pos != std::string::npos) {
+    const glm::vec3 & pos(gameObject.getSpatial()->position());
+    target.groundPos = pos;
+    auto pair(CollisionSystem::pickHeavy(Ray(pos, glm::vec3(0, -1, 0.01)), UINT_MAX, nullptr, Util::infinity(), BounderComponent::k_staticLayer));
+    if (pair.second.is) {
+        target.groundPos.y -= pair.second.dist;
+    }
 
-                    x = std::stof(token.substr(5, 8));
+    uint32_t node(nearestNode(s_graph, target.groundPos));
+    if (node != target.field.target()) {
+        target.field.build(s_graph, node, k_fieldRadius);
+        ++target.version;
+    }
+    target.isCurrent = true;
+    return target;
+}
 
-                    std::getline(iss, token, ',');
-                    y = std::stof(token.substr(1, 8));
+unsigned int PathfindingSystem::requestPath(const glm::vec3 & start, const glm::vec3 & goal, PathCallback && callback) {
+    unsigned int id(s_nextRequestId++);
+    s_requests.push_back(PathRequest{ id, start, goal, std::move(callback) });
+    return id;
+}
 
-                    std::getline(iss, token, ',');
-                    z = std::stof(token.substr(1, 8));
+void PathfindingSystem::cancelPath(unsigned int request) {
+    // ids increase along the queue
+    auto it(std::lower_bound(s_requests.begin() + s_nextRequestI, s_requests.end(), request, [](const PathRequest & r, unsigned int id) { return r.id < id; }));
+    if (it != s_requests.end() && it->id == request) {
+        it->callback = nullptr;
+    }
+}
 
-                    neighbors.push_back(glm::vec3(x, y, z));
+void PathfindingSystem::solveRequests() {
+    int nRequests(int(s_requests.size()));
+    double startT(Util::time());
+    while (s_nextRequestI < nRequests) {
+        PathRequest & request(s_requests[s_nextRequestI++]);
+        if (!request.callback) {
+            continue;
+        }
+        bool found(findLevelPath(request.start, request.goal, s_requestPath));
+        // the callback may queue more requests, which would move this one
+        PathCallback callback(std::move(request.callback));
+        callback(found, s_requestPath);
+        if (Util::time() - startT >= s_pathBudget) {
+            break;
+        }
+    }
 
-                }
-            }
+    // solved requests are dropped once they're at least half the queue, so
+    // the rest are shifted down rarely
+    if (s_nextRequestI * 2 >= int(s_requests.size())) {
+        s_requests.erase(s_requests.begin(), s_requests.begin() + s_nextRequestI);
+        s_nextRequestI = 0;
+    }
+}
 
-            graph.emplace(nodePos, neighbors);
-        }
+void PathfindingSystem::readInGraph(const String & fileName, NavGraph & r_graph) {
+    if (r_graph.read(navFileName(fileName)) && r_graph.isFromText(fileName)) {
+        return;
+    }
+    // without the text, the binary form is all there is, stale or not
+    if (!r_graph.readText(fileName)) {
+        r_graph.read(navFileName(fileName));
+    }
+}
 
+NavHierarchy & PathfindingSystem::levelHierarchy() {
+    if (!s_isHierarchyLoaded) {
+        readInHierarchy(zonesFileName(k_graphFileName), s_graph, s_hierarchy);
+        s_isHierarchyLoaded = true;
     }
+    return s_hierarchy;
+}
 
-}
\ No newline at end of file
+void PathfindingSystem::readInHierarchy(const String & fileName, const NavGraph & graph, NavHierarchy & r_hierarchy) {
+    if (!r_hierarchy.read(fileName) || !r_hierarchy.matches(graph)) {
+        r_hierarchy.build(graph);
+    }
+}
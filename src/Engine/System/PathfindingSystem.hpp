@@ -1,11 +1,16 @@
 #pragma once
 
+#include <functional>
+
 #include "System.hpp"
 #include "Util/Memory.hpp"
+#include "Util/NavGraph.hpp"
+#include "Util/NavHierarchy.hpp"
 
 //#include "../Component/PathfindingComponents/PathfindingComponent.hpp"
 
 class Scene;
+class GameObject;
 class PathfindingComponent;
 
 
@@ -14,13 +19,14 @@ class PathfindingSystem {
 
 public:
 
+	// only hashes x and z, as positions count as equal when their y values
+	// are merely close
 	struct vecHash
 	{
 	  size_t operator()(const glm::vec3 &v) const {
 	    size_t h1 = std::hash<int>()(int(round(v.x)));
-	    size_t h2 = std::hash<int>()(int(round(v.y)));
 	    size_t h3 = std::hash<int>()(int(round(v.z)));
-	    return (h1 ^ (h2 << 1)) ^ h3;
+	    return (h1 << 1) ^ h3;
 	  }
 	};
 
@@ -37,24 +43,117 @@ public:
 	    }
 	};
 
-	typedef std::unordered_map<glm::vec3, glm::vec3, vecHash, gridCompare> vecvecMap;
-	typedef std::unordered_map<glm::vec3, double, vecHash, gridCompare> vecdoubleMap;
 	typedef std::unordered_map<glm::vec3, Vector<glm::vec3>, vecHash, gridCompare> vecvectorMap;
 
     friend Scene;
     
     public:
 
+    // Something being chased, with a field over the nav graph leading to it
+    // that all its chasers share. The field only reaches so far, and chasers
+    // beyond it request paths of their own
+    struct Target {
+
+        glm::vec3 groundPos; // below the target, or its position if there's no ground
+        NavField field; // toward the node nearest groundPos, out to k_fieldRadius
+        unsigned int version = 0; // changes whenever the field is rebuilt
+        bool isCurrent = false; // brought up to date this update
+
+    };
+
+    // Given whether a path was found and the positions along it
+    using PathCallback = std::function<void(bool, const Vector<glm::vec3> &)>;
+
+    // nodes further above or below a position than this are on another floor
+    static constexpr float k_halfStairs = 3.0f;
+    // how many edges from its target a target's field reaches, which bounds
+    // what rebuilding it costs as the target moves
+    static constexpr uint32_t k_fieldRadius = 64;
+    // default time each update may spend solving queued path requests
+    static constexpr double k_defPathBudget = 0.001;
+
     static void init();
 
     static void update(float dt);
 
-    static vecvectorMap graph;
+    static const NavGraph & graph() { return s_graph; }
+
+    // The level graph's zones, read or built the first time they're wanted,
+    // as only long searches use them
+    static const NavHierarchy & hierarchy() { return levelHierarchy(); }
+
+    // Builds a nav graph from positions mapped to their neighbors
+    static void buildGraph(const vecvectorMap & map, NavGraph & r_graph);
+
+    // The node nearest to pos on the same floor, or NavGraph::k_invalid
+    static uint32_t nearestNode(const NavGraph & graph, const glm::vec3 & pos);
+
+    // Finds a path from the node nearest start to the node nearest goal, and
+    // fills r_path with the positions of the nodes along it
+    static bool findPath(const NavGraph & graph, const glm::vec3 & start, const glm::vec3 & goal, Vector<glm::vec3> & r_path);
+
+    // As above, over the level's graph, by way of its zones
+    static bool findLevelPath(const glm::vec3 & start, const glm::vec3 & goal, Vector<glm::vec3> & r_path);
+
+    // The files the binary form and the zones of the graph in graphFileName
+    // are kept in, which are the same but for the extension
+    static String navFileName(const String & graphFileName);
+    static String zonesFileName(const String & graphFileName);
+
+    // The target for chasing gameObject. Brought up to date on the first call
+    // each update, where the field is only rebuilt if the target has moved
+    // to another node
+    static const Target & target(const GameObject & gameObject);
+
+    // Queues a search over the level's graph from the node nearest start to
+    // the node nearest goal. Requests are solved in order at the start of
+    // later updates, as many as fit in the budget, and callback is called
+    // from there. Returns an id for cancelling it
+    static unsigned int requestPath(const glm::vec3 & start, const glm::vec3 & goal, PathCallback && callback);
+
+    // The request's callback won't be called. Does nothing if it already has
+    static void cancelPath(unsigned int request);
+
+    // At least one request is solved each update, however long it takes
+    static void setPathBudget(double seconds) { s_pathBudget = seconds; }
+
+    static int nPendingPaths() { return int(s_requests.size()) - s_nextRequestI; }
 
     private:
 
-    static const Vector<PathfindingComponent *> & s_pathfindingComponents;
+    struct PathRequest {
+
+        unsigned int id;
+        glm::vec3 start, goal;
+        PathCallback callback; // empty if cancelled
+
+    };
 
-    static void readInGraph(String, vecvectorMap &);
+    static void solveRequests();
+
+    static const Vector<PathfindingComponent *> & s_pathfindingComponents;
 
-};
\ No newline at end of file
+    static NavGraph s_graph;
+    static NavHierarchy s_hierarchy;
+    static bool s_isHierarchyLoaded;
+    static NavSearch s_search;
+    static Vector<uint32_t> s_nodePath;
+    static UnorderedMap<const GameObject *, Target> s_targets;
+    static Vector<PathRequest> s_requests;
+    static int s_nextRequestI; // requests before this are solved
+    static unsigned int s_nextRequestId;
+    static double s_pathBudget;
+    static Vector<glm::vec3> s_requestPath;
+
+    // Reads the binary form kept with the graph if there is one and it was
+    // made from the graph as it is now, as it loads much faster, and
+    // otherwise the graph itself
+    static void readInGraph(const String & fileName, NavGraph & r_graph);
+
+    static NavHierarchy & levelHierarchy();
+
+    // Reads the zones kept with the graph, or builds them if they're missing
+    // or were made from a different graph
+    static void readInHierarchy(const String & fileName, const NavGraph & graph, NavHierarchy & r_hierarchy);
+
+};
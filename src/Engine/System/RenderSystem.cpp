@@ -7,6 +7,9 @@
 #include "Component/CameraComponents/CameraComponent.hpp"
 #include "Component/SpatialComponents/SpatialComponent.hpp"
 #include "Component/RenderComponents/DiffuseRenderComponent.hpp"
+#include "Component/EnemyComponents/EnemyComponent.hpp"
+#include "Component/StatComponents/StatComponents.hpp"
+#include "System/GameInterface.hpp"
 #include "Util/Util.hpp"
 
 // Necessary for light debug
@@ -22,6 +25,8 @@ GLuint RenderSystem::s_fboColorTexs[2];
 GLuint RenderSystem::s_pingpongFBO[2];
 GLuint RenderSystem::s_pingpongColorbuffers[2];
 bool RenderSystem::s_wasResize = false;
+float RenderSystem::s_interpP = 1.0f;
+RenderSnapshot RenderSystem::s_snapshot;
 /* Camera and light */
 const CameraComponent * RenderSystem::s_playerCamera = nullptr;
 GameObject * RenderSystem::s_lightObject = nullptr;
@@ -102,24 +107,111 @@ void RenderSystem::init() {
     initFBO();
 }
 
-void RenderSystem::update(float dt) {
-    /* Handle window resize */
-    if (s_wasResize) {
-        doResize();
-        s_wasResize = false;
+const RenderSnapshot::View * RenderSnapshot::view(const CameraComponent * camera) const {
+    if (!camera) {
+        return nullptr;
+    }
+    if (camera == playerView.camera) {
+        return &playerView;
     }
+    if (camera == lightView.camera) {
+        return &lightView;
+    }
+    return nullptr;
+}
+
+void RenderSystem::update(float dt, float interpP) {
+    capture(dt, interpP);
+    draw();
+}
+
+void RenderSystem::capture(float dt, float interpP) {
+    s_interpP = interpP;
 
     /* Update render components */
     for (DiffuseRenderComponent * comp : s_diffuseComponents) {
         comp->update(dt);
     }
 
-    if (!s_playerCamera) {
+    /* Diffuses, in the same order as the components */
+    s_snapshot.diffuses.clear();
+    for (const DiffuseRenderComponent * comp : s_diffuseComponents) {
+        s_snapshot.diffuses.push_back(RenderSnapshot::Diffuse{
+            &comp->mesh(),
+            comp->modelTexture(),
+            comp->m_spatial->modelMatrix(interpP),
+            comp->m_spatial->normalMatrix(interpP),
+            comp->tiling(),
+            comp->isToon(),
+            comp->isNeon()
+        });
+    }
+
+    /* Cameras and what they see */
+    captureView(s_playerCamera, s_snapshot.playerView);
+    captureView(s_lightCamera, s_snapshot.lightView);
+
+    /* Health bars */
+    s_snapshot.healthBars.clear();
+    for (EnemyComponent * enemy : Scene::getComponents<EnemyComponent>()) {
+        HealthComponent * health(enemy->gameObject().getComponentByType<HealthComponent>());
+        const Vector<SpatialComponent *> & spatials(enemy->gameObject().getComponentsByType<SpatialComponent>());
+        if (!health || spatials.size() < 2) {
+            break;
+        }
+        s_snapshot.healthBars.push_back(RenderSnapshot::HealthBar{
+            spatials[1]->position(interpP) + glm::vec3(0.0f, 0.75f, 0.0f), // above the body
+            health->minValue(),
+            health->value(),
+            health->maxValue()
+        });
+    }
+
+    /* Light */
+    s_snapshot.lightDir = getLightDir();
+    s_snapshot.ambience = GameInterface::getAmbience();
+
+    /* Post processing and ui */
+    s_snapshot.screenTone = s_postProcessShader->screenTone();
+    HealthComponent * health(GameInterface::getPlayer().getComponentByType<HealthComponent>());
+    s_snapshot.lifePercent = health ? (health->value() - health->minValue()) / (health->maxValue() - health->minValue()) : 0.0f;
+    AmmoComponent * ammo(GameInterface::getPlayer().getComponentByType<AmmoComponent>());
+    s_snapshot.ammoPercent = ammo ? (ammo->value() - ammo->minValue()) / (ammo->maxValue() - ammo->minValue()) : 0.0f;
+}
+
+void RenderSystem::captureView(const CameraComponent * camera, RenderSnapshot::View & r_view) {
+    r_view.camera = camera;
+    r_view.diffuseIs.clear();
+    if (!camera) {
+        return;
+    }
+
+    r_view.proj = camera->getProj();
+    r_view.view = camera->getView();
+    r_view.position = camera->gameObject().getSpatial()->position(s_interpP);
+    for (int i(0); i < int(s_diffuseComponents.size()); ++i) {
+        if (camera->sphereInFrustum(s_diffuseComponents[i]->enclosingSphere())) {
+            r_view.diffuseIs.push_back(i);
+        }
+    }
+}
+
+void RenderSystem::draw() {
+    /* Handle window resize */
+    if (s_wasResize) {
+        doResize();
+        s_wasResize = false;
+    }
+
+    /* The cameras as captured, as the live ones may be changed by a step running alongside */
+    const CameraComponent * playerCamera(s_snapshot.playerView.camera);
+    const CameraComponent * lightCamera(s_snapshot.lightView.camera);
+    if (!playerCamera) {
         return;
     }
 
     /* Render shadow map */
-    s_shadowShader->render(s_lightCamera);
+    s_shadowShader->render(lightCamera);
 
     /* Set up post process FBO */
     if (s_postProcessShader->isEnabled()) {
@@ -138,23 +230,28 @@ void RenderSystem::update(float dt) {
     glViewport(0, 0, size.x, size.y);
 
     /* Render! */
-    s_diffuseShader->render(s_playerCamera);
-    s_bounderShader->render(s_playerCamera);
-    s_octreeShader->render(s_playerCamera);
-    s_rayShader->render(s_playerCamera);
-    s_healthShader->render(s_playerCamera);
+    s_diffuseShader->render(playerCamera);
+    s_bounderShader->render(playerCamera);
+    s_octreeShader->render(playerCamera);
+    s_rayShader->render(playerCamera);
+    s_healthShader->render(playerCamera);
 
     /* Rebind screen FBO */
     if (s_postProcessShader->isEnabled()) {
         doBloom();
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        s_postProcessShader->render(s_playerCamera);
+        s_postProcessShader->render(playerCamera);
     }
     
     /* Update light -- done here to sync with other game logic */
     //updateLightCamera();
 }
+
+bool RenderSystem::canDrawConcurrently() {
+    return !s_bounderShader->isEnabled() && !s_octreeShader->isEnabled() && !s_rayShader->isEnabled();
+}
+
 void RenderSystem::setCamera(const CameraComponent * camera) {
     s_playerCamera = camera;
 }
@@ -9,6 +9,7 @@
 #include <iostream>
 
 #include "System.hpp"
+#include "Model/ModelTexture.hpp"
 
 #include "Shaders/DiffuseShader.hpp"
 #include "Shaders/BounderShader.hpp"
@@ -22,6 +23,57 @@
 
 
 class DiffuseRenderComponent;
+class Mesh;
+
+
+
+// Everything drawing reads from the scene, captured between simulation steps.
+// Drawing only reads this, so the next step may run while it's drawn
+struct RenderSnapshot {
+
+    struct Diffuse {
+
+        const Mesh * mesh;
+        ModelTexture modelTexture;
+        glm::mat4 modelMat; // interpolated
+        glm::mat3 normalMat; // interpolated
+        glm::vec2 tiling;
+        bool isToon;
+        bool isNeon;
+
+    };
+
+    struct View {
+
+        const CameraComponent * camera; // only identifies the view, isn't read while drawing
+        glm::mat4 proj;
+        glm::mat4 view;
+        glm::vec3 position;
+        Vector<int> diffuseIs; // the diffuses within the camera's frustum
+
+    };
+
+    struct HealthBar {
+
+        glm::vec3 center;
+        float minVal, curVal, maxVal;
+
+    };
+
+    // the view captured for the camera, or null if there isn't one
+    const View * view(const CameraComponent * camera) const;
+
+    Vector<Diffuse> diffuses;
+    View playerView;
+    View lightView;
+    Vector<HealthBar> healthBars;
+    glm::vec3 lightDir;
+    float ambience;
+    glm::vec3 screenTone;
+    float lifePercent; // of the player, for the ui
+    float ammoPercent;
+
+};
 
 
 
@@ -34,8 +86,24 @@ public:
 
     static void init();
 
+    /* Captures what is to be drawn from the scene */
+    /* Transforms are interpolated by interpP between the previous and latest simulation steps */
+    static void capture(float dt, float interpP);
+
     /* Full render function including shadow maps, main render calls, and post-processing */
-    static void update(float dt);
+    /* Draws the last capture, so doesn't touch the scene unless a debug shader is enabled */
+    static void draw();
+
+    /* Capture and draw */
+    static void update(float dt, float interpP);
+
+    static float interpP() { return s_interpP; }
+
+    static const RenderSnapshot & snapshot() { return s_snapshot; }
+
+    /* Whether drawing may overlap the next simulation step, which it can't */
+    /* while the bounder, octree, or ray shaders read the live scene */
+    static bool canDrawConcurrently();
 
     /* Camera */
     static void setCamera(const CameraComponent * camera);
@@ -77,7 +145,11 @@ private:
 
     static void doBloom();
 
+    static void captureView(const CameraComponent * camera, RenderSnapshot::View & r_view);
+
     static const Vector<DiffuseRenderComponent *> & s_diffuseComponents;
+    static float s_interpP;
+    static RenderSnapshot s_snapshot;
 
     static void initFBO();
     static void doResize();
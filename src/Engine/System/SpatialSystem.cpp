@@ -1,9 +1,13 @@
 #include "SpatialSystem.hpp"
 
+#include "glm/gtx/norm.hpp"
+
 #include "Scene/Scene.hpp"
 #include "Component/SpatialComponents/SpatialComponent.hpp"
 #include "Component/SpatialComponents/PhysicsComponents.hpp"
 #include "Component/SpatialComponents/AnimationComponents.hpp"
+#include "Util/Util.hpp"
+#include "Util/SSE.hpp"
 
 
 
@@ -13,28 +17,161 @@ const float SpatialSystem::k_elasticity = 2.0f / 3.0f;
 const float SpatialSystem::k_bounceVelThreshold = 0.5f;
 
 const Vector<SpatialComponent *> & SpatialSystem::s_spatialComponents(Scene::getComponents<SpatialComponent>());
-const Vector<NewtonianComponent *> & SpatialSystem::s_newtonianComponents(Scene::getComponents<NewtonianComponent>());
 const Vector<AcceleratorComponent *> & SpatialSystem::s_acceleratorComponents(Scene::getComponents<AcceleratorComponent>());
 const Vector<AnimationComponent *> & SpatialSystem::s_animationComponents(Scene::getComponents<AnimationComponent>());
 glm::vec3 SpatialSystem::s_gravityDir = glm::vec3(0.0f, 0.0f, 0.0f);
 float SpatialSystem::s_gravityMag = 0.0f;
+SpatialSystem::Bodies SpatialSystem::s_bodies;
+Vector<const SpatialComponent *> SpatialSystem::s_moved;
 
 void SpatialSystem::init() {
-
+    auto compRemovedCallback(
+        [&](const Message & msg_) {
+            const ComponentRemovedMessage & msg(static_cast<const ComponentRemovedMessage &>(msg_));
+            if (msg.typeI == typeid(NewtonianComponent)) {
+                const NewtonianComponent & comp(static_cast<const NewtonianComponent &>(*msg.comp));
+                if (comp.m_bodyI >= 0) {
+                    removeBody(comp.m_bodyI);
+                }
+            }
+        }
+    );
+    Scene::addReceiver<ComponentRemovedMessage>(nullptr, compRemovedCallback);
 }
 
 void SpatialSystem::update(float dt) {
-    for (auto & comp : s_acceleratorComponents) {
-        comp->update(dt);
-    }
-    for (auto & comp : s_newtonianComponents) {
-        comp->update(dt);
+    const glm::vec3 gravity(SpatialSystem::gravity());
+    for (const AcceleratorComponent * comp : s_acceleratorComponents) {
+        comp->m_newtonian->accelerate(comp->m_isGravity ? gravity : comp->m_acceleration);
     }
+    integrate(dt);
     for (auto & comp : s_animationComponents) {
         comp->update(dt);
     }
 }
 
+void SpatialSystem::integrate(float dt) {
+    Bodies & b(s_bodies);
+    const int n(int(b.comps.size()));
+    const float maxSpeed2(k_terminalVelocity * k_terminalVelocity);
+    int i(0);
+
+#ifdef UTIL_SSE
+    // same operations in the same order as the loop below, four bodies at once
+    const __m128 dt4(_mm_set1_ps(dt)), half4(_mm_set1_ps(0.5f)), one4(_mm_set1_ps(1.0f));
+    const __m128 terminal4(_mm_set1_ps(k_terminalVelocity)), maxSpeed2_4(_mm_set1_ps(maxSpeed2));
+    const __m128 zero4(_mm_setzero_ps());
+    for (; i + 4 <= n; i += 4) {
+        const __m128 active(_mm_loadu_ps(&b.isActive[i]));
+        const __m128 vx(_mm_loadu_ps(&b.vx[i])), vy(_mm_loadu_ps(&b.vy[i])), vz(_mm_loadu_ps(&b.vz[i]));
+        __m128 nvx(_mm_add_ps(vx, _mm_mul_ps(_mm_mul_ps(active, _mm_loadu_ps(&b.ax[i])), dt4)));
+        __m128 nvy(_mm_add_ps(vy, _mm_mul_ps(_mm_mul_ps(active, _mm_loadu_ps(&b.ay[i])), dt4)));
+        __m128 nvz(_mm_add_ps(vz, _mm_mul_ps(_mm_mul_ps(active, _mm_loadu_ps(&b.az[i])), dt4)));
+        const __m128 speed2(SSE::length2_4(nvx, nvy, nvz));
+        // lanes under terminal velocity may divide by zero, but aren't selected
+        const __m128 factor(SSE::select4(_mm_cmpgt_ps(speed2, maxSpeed2_4), _mm_div_ps(terminal4, _mm_sqrt_ps(speed2)), one4));
+        nvx = _mm_add_ps(vx, _mm_mul_ps(active, _mm_sub_ps(_mm_mul_ps(nvx, factor), vx)));
+        nvy = _mm_add_ps(vy, _mm_mul_ps(active, _mm_sub_ps(_mm_mul_ps(nvy, factor), vy)));
+        nvz = _mm_add_ps(vz, _mm_mul_ps(active, _mm_sub_ps(_mm_mul_ps(nvz, factor), vz)));
+        const __m128 step(_mm_mul_ps(_mm_mul_ps(active, half4), dt4));
+        _mm_storeu_ps(&b.dx[i], _mm_mul_ps(step, _mm_add_ps(vx, nvx)));
+        _mm_storeu_ps(&b.dy[i], _mm_mul_ps(step, _mm_add_ps(vy, nvy)));
+        _mm_storeu_ps(&b.dz[i], _mm_mul_ps(step, _mm_add_ps(vz, nvz)));
+        _mm_storeu_ps(&b.vx[i], nvx);
+        _mm_storeu_ps(&b.vy[i], nvy);
+        _mm_storeu_ps(&b.vz[i], nvz);
+        _mm_storeu_ps(&b.ax[i], zero4);
+        _mm_storeu_ps(&b.ay[i], zero4);
+        _mm_storeu_ps(&b.az[i], zero4);
+    }
+#endif
+
+    // the remaining bodies, or all of them without SSE
+    for (; i < n; ++i) {
+        // asleep bodies neither accelerate nor move
+        const float active(b.isActive[i]);
+        float nvx(b.vx[i] + active * b.ax[i] * dt);
+        float nvy(b.vy[i] + active * b.ay[i] * dt);
+        float nvz(b.vz[i] + active * b.az[i] * dt);
+        const float speed2(nvx * nvx + nvy * nvy + nvz * nvz);
+        const float factor(speed2 > maxSpeed2 ? k_terminalVelocity / std::sqrt(speed2) : 1.0f);
+        nvx = b.vx[i] + active * (nvx * factor - b.vx[i]);
+        nvy = b.vy[i] + active * (nvy * factor - b.vy[i]);
+        nvz = b.vz[i] + active * (nvz * factor - b.vz[i]);
+        b.dx[i] = active * 0.5f * dt * (b.vx[i] + nvx);
+        b.dy[i] = active * 0.5f * dt * (b.vy[i] + nvy);
+        b.dz[i] = active * 0.5f * dt * (b.vz[i] + nvz);
+        b.vx[i] = nvx;
+        b.vy[i] = nvy;
+        b.vz[i] = nvz;
+        b.ax[i] = 0.0f;
+        b.ay[i] = 0.0f;
+        b.az[i] = 0.0f;
+    }
+
+    // the spatials are only touched once all bodies are integrated, and are
+    // moved silently so that collision and cameras hear of them all at once
+    s_moved.clear();
+    for (int i(0); i < n; ++i) {
+        glm::vec3 delta(b.dx[i], b.dy[i], b.dz[i]);
+        if (!Util::isZero(glm::length2(delta))) {
+            SpatialComponent & spatial(*b.comps[i]->m_spatial);
+            spatial.move(delta, true);
+            addMoved(spatial);
+        }
+    }
+    if (!s_moved.empty()) {
+        Scene::sendMessage<SpatialsMovedMessage>(nullptr, s_moved.data(), int(s_moved.size()));
+    }
+}
+
+void SpatialSystem::addMoved(const SpatialComponent & spatial) {
+    s_moved.push_back(&spatial);
+    for (const SpatialComponent * child : spatial.m_children) {
+        addMoved(*child);
+    }
+}
+
+int SpatialSystem::addBody(NewtonianComponent & comp) {
+    Bodies & b(s_bodies);
+    b.comps.push_back(&comp);
+    b.vx.push_back(0.0f); b.vy.push_back(0.0f); b.vz.push_back(0.0f);
+    b.ax.push_back(0.0f); b.ay.push_back(0.0f); b.az.push_back(0.0f);
+    b.dx.push_back(0.0f); b.dy.push_back(0.0f); b.dz.push_back(0.0f);
+    b.isActive.push_back(0.0f);
+    return int(b.comps.size()) - 1;
+}
+
+void SpatialSystem::removeBody(int bodyI) {
+    Bodies & b(s_bodies);
+    int lastI(int(b.comps.size()) - 1);
+    if (bodyI != lastI) {
+        b.comps[bodyI] = b.comps[lastI];
+        b.comps[bodyI]->m_bodyI = bodyI;
+        b.vx[bodyI] = b.vx[lastI]; b.vy[bodyI] = b.vy[lastI]; b.vz[bodyI] = b.vz[lastI];
+        b.ax[bodyI] = b.ax[lastI]; b.ay[bodyI] = b.ay[lastI]; b.az[bodyI] = b.az[lastI];
+        b.dx[bodyI] = b.dx[lastI]; b.dy[bodyI] = b.dy[lastI]; b.dz[bodyI] = b.dz[lastI];
+        b.isActive[bodyI] = b.isActive[lastI];
+    }
+    b.comps.pop_back();
+    b.vx.pop_back(); b.vy.pop_back(); b.vz.pop_back();
+    b.ax.pop_back(); b.ay.pop_back(); b.az.pop_back();
+    b.dx.pop_back(); b.dy.pop_back(); b.dz.pop_back();
+    b.isActive.pop_back();
+}
+
+void SpatialSystem::setBodyVelocity(int bodyI, const glm::vec3 & velocity) {
+    s_bodies.vx[bodyI] = velocity.x;
+    s_bodies.vy[bodyI] = velocity.y;
+    s_bodies.vz[bodyI] = velocity.z;
+}
+
+void SpatialSystem::accelerateBody(int bodyI, const glm::vec3 & acceleration) {
+    s_bodies.ax[bodyI] += acceleration.x;
+    s_bodies.ay[bodyI] += acceleration.y;
+    s_bodies.az[bodyI] += acceleration.z;
+}
+
 void SpatialSystem::setGravity(const glm::vec3 & gravity) {
     if (gravity == glm::vec3()) {
         s_gravityDir = glm::vec3();
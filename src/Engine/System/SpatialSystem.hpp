@@ -21,6 +21,7 @@ class AnimationComponent;
 class SpatialSystem {
 
     friend Scene;
+    friend NewtonianComponent;
 
     public:
 
@@ -45,11 +46,44 @@ class SpatialSystem {
 
     private:
 
+    // Newtonian bodies as a structure of arrays, so that they can be integrated
+    // four at a time. A NewtonianComponent's slot is its m_bodyI, and slots
+    // stay dense by moving the last into a removed one
+    struct Bodies {
+
+        Vector<NewtonianComponent *> comps;
+        Vector<float> vx, vy, vz; // velocity
+        Vector<float> ax, ay, az; // acceleration built up this step
+        Vector<float> dx, dy, dz; // movement this step
+        Vector<float> isActive; // 1 if awake, else 0
+
+    };
+
+    // Integrates every body's acceleration and velocity, clamped to terminal
+    // velocity, and then moves each spatial silently, sending one
+    // SpatialsMovedMessage for them all
+    static void integrate(float dt);
+
+    // adds the spatial and all its descendants to s_moved
+    static void addMoved(const SpatialComponent & spatial);
+
+    static int addBody(NewtonianComponent & comp);
+    static void removeBody(int bodyI);
+
+    static glm::vec3 bodyVelocity(int bodyI) {
+        return glm::vec3(s_bodies.vx[bodyI], s_bodies.vy[bodyI], s_bodies.vz[bodyI]);
+    }
+    static void setBodyVelocity(int bodyI, const glm::vec3 & velocity);
+    static void accelerateBody(int bodyI, const glm::vec3 & acceleration);
+
+    private:
+
     static const Vector<SpatialComponent *> & s_spatialComponents;
-    static const Vector<NewtonianComponent *> & s_newtonianComponents;
     static const Vector<AcceleratorComponent *> & s_acceleratorComponents;
     static const Vector<AnimationComponent *> & s_animationComponents;
     static glm::vec3 s_gravityDir;
     static float s_gravityMag;
+    static Bodies s_bodies;
+    static Vector<const SpatialComponent *> s_moved; // by the last integrate
 
 };
\ No newline at end of file
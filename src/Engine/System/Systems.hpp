@@ -3,6 +3,7 @@
 #include "GameSystem.hpp"
 #include "RenderSystem.hpp"
 #include "SpatialSystem.hpp"
+#include "TransformSystem.hpp"
 #include "CollisionSystem.hpp"
 #include "PostCollisionSystem.hpp"
 #include "PathfindingSystem.hpp"
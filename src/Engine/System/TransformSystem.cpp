@@ -0,0 +1,107 @@
+#include "TransformSystem.hpp"
+
+#include "Scene/Scene.hpp"
+#include "Component/SpatialComponents/SpatialComponent.hpp"
+
+
+
+TransformSystem::Transforms TransformSystem::s_transforms;
+bool TransformSystem::s_isOrderValid = false;
+
+void TransformSystem::init() {
+    // spatials add and remove their own slots, which invalidates the order
+}
+
+void TransformSystem::update() {
+    if (!s_isOrderValid) {
+        buildOrder();
+    }
+
+    // each parent is brought up to date before its children, so a child only
+    // ever needs its parent's matrix as is
+    Transforms & t(s_transforms);
+    for (int i(0); i < int(t.spatials.size()); ++i) {
+        const SpatialComponent & spat(*t.spatials[i]);
+        const int parentI(t.parentIs[i]);
+
+        if (!t.isModelValid[i]) {
+            t.models[i] = spat.localModelMatrix();
+            if (parentI >= 0) t.models[i] = t.models[parentI] * t.models[i];
+            t.isModelValid[i] = true;
+        }
+        if (!t.isPrevModelValid[i]) {
+            t.prevModels[i] = spat.prevLocalModelMatrix();
+            if (parentI >= 0) t.prevModels[i] = t.prevModels[parentI] * t.prevModels[i];
+            t.isPrevModelValid[i] = true;
+        }
+        if (!t.isNormalValid[i]) {
+            t.normals[i] = spat.localNormalMatrix();
+            if (parentI >= 0) t.normals[i] = t.normals[parentI] * t.normals[i];
+            t.isNormalValid[i] = true;
+        }
+        if (!t.isPrevNormalValid[i]) {
+            t.prevNormals[i] = spat.prevLocalNormalMatrix();
+            if (parentI >= 0) t.prevNormals[i] = t.prevNormals[parentI] * t.prevNormals[i];
+            t.isPrevNormalValid[i] = true;
+        }
+    }
+}
+
+void TransformSystem::buildOrder() {
+    Transforms & t(s_transforms);
+    // the old slot of each spatial in the new order, roots followed by breadth
+    // first descendants, dropping removed ones
+    Vector<int> order;
+    Vector<int> parentIs;
+    order.reserve(t.spatials.size());
+    parentIs.reserve(t.spatials.size());
+    for (int i(0); i < int(t.spatials.size()); ++i) {
+        if (t.spatials[i] && !t.spatials[i]->m_parent) {
+            order.push_back(i);
+            parentIs.push_back(-1);
+        }
+    }
+    for (int i(0); i < int(order.size()); ++i) {
+        for (SpatialComponent * child : t.spatials[order[i]]->m_children) {
+            order.push_back(child->m_transformI);
+            parentIs.push_back(i);
+        }
+    }
+
+    Transforms ordered;
+    int n(int(order.size()));
+    ordered.spatials.resize(n);
+    ordered.models.resize(n); ordered.prevModels.resize(n);
+    ordered.normals.resize(n); ordered.prevNormals.resize(n);
+    ordered.isModelValid.resize(n); ordered.isPrevModelValid.resize(n);
+    ordered.isNormalValid.resize(n); ordered.isPrevNormalValid.resize(n);
+    for (int i(0); i < n; ++i) {
+        int oldI(order[i]);
+        ordered.spatials[i] = t.spatials[oldI];
+        ordered.spatials[i]->m_transformI = i;
+        ordered.models[i] = t.models[oldI]; ordered.prevModels[i] = t.prevModels[oldI];
+        ordered.normals[i] = t.normals[oldI]; ordered.prevNormals[i] = t.prevNormals[oldI];
+        ordered.isModelValid[i] = t.isModelValid[oldI]; ordered.isPrevModelValid[i] = t.isPrevModelValid[oldI];
+        ordered.isNormalValid[i] = t.isNormalValid[oldI]; ordered.isPrevNormalValid[i] = t.isPrevNormalValid[oldI];
+    }
+    ordered.parentIs = std::move(parentIs);
+    t = std::move(ordered);
+    s_isOrderValid = true;
+}
+
+int TransformSystem::addSlot(SpatialComponent & spatial) {
+    Transforms & t(s_transforms);
+    t.spatials.push_back(&spatial);
+    t.parentIs.push_back(-1);
+    t.models.emplace_back(); t.prevModels.emplace_back();
+    t.normals.emplace_back(); t.prevNormals.emplace_back();
+    t.isModelValid.push_back(false); t.isPrevModelValid.push_back(false);
+    t.isNormalValid.push_back(false); t.isPrevNormalValid.push_back(false);
+    invalidateOrder();
+    return int(t.spatials.size()) - 1;
+}
+
+void TransformSystem::removeSlot(int slotI) {
+    s_transforms.spatials[slotI] = nullptr;
+    invalidateOrder();
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+
+
+#include "glm/glm.hpp"
+
+#include "System.hpp"
+#include "Util/Memory.hpp"
+
+
+
+class Scene;
+class SpatialComponent;
+
+
+
+// static class
+// Owns the model and normal matrices of every spatial, stored in flat arrays
+// in an order where parents come before their children, and brings all stale
+// ones up to date in a single pass down those arrays. Run before collision and
+// rendering so that they only read matrices that are already valid, rather
+// than each lazily walking up its parents
+class TransformSystem {
+
+    friend Scene;
+    friend SpatialComponent;
+
+    public:
+
+    static void init();
+
+    static void update();
+
+    private:
+
+    // A spatial's matrices are in its slot, SpatialComponent::m_transformI. A
+    // new spatial's slot is added to the end, and a removed one's is left
+    // empty, until the order is next built. So references to matrices only
+    // last until then, or until another spatial is made
+    struct Transforms {
+
+        Vector<SpatialComponent *> spatials; // null where removed
+        Vector<int> parentIs; // slot of each spatial's parent, or -1
+        Vector<glm::mat4> models, prevModels;
+        Vector<glm::mat3> normals, prevNormals;
+        Vector<unsigned char> isModelValid, isPrevModelValid;
+        Vector<unsigned char> isNormalValid, isPrevNormalValid;
+
+    };
+
+    // the hierarchy has changed and the order must be rebuilt
+    static void invalidateOrder() { s_isOrderValid = false; }
+
+    static void buildOrder();
+
+    // returns the new spatial's slot
+    static int addSlot(SpatialComponent & spatial);
+    static void removeSlot(int slotI);
+
+    private:
+
+    static Transforms s_transforms;
+    static bool s_isOrderValid;
+
+};
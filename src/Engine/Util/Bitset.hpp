@@ -0,0 +1,91 @@
+#pragma once
+
+
+
+#include <cstdint>
+
+#include "Memory.hpp"
+
+
+
+// A dynamically sized set of bits, stored as a flat array of words
+// Setting a bit beyond the current size grows the set
+class Bitset {
+
+    using Word = uint64_t;
+
+    static constexpr int k_wordBits = 64;
+
+    public:
+
+    Bitset() = default;
+
+    bool test(int i) const {
+        int wordI(i / k_wordBits);
+        return i >= 0 && wordI < int(m_words.size()) && (m_words[wordI] >> (i % k_wordBits)) & 1;
+    }
+
+    // returns whether the bit was not already set
+    bool set(int i) {
+        int wordI(i / k_wordBits);
+        if (wordI >= int(m_words.size())) {
+            m_words.resize(wordI + 1, 0);
+        }
+        Word bit(Word(1) << (i % k_wordBits));
+        bool was(m_words[wordI] & bit);
+        m_words[wordI] |= bit;
+        return !was;
+    }
+
+    void reset(int i) {
+        int wordI(i / k_wordBits);
+        if (wordI < int(m_words.size())) {
+            m_words[wordI] &= ~(Word(1) << (i % k_wordBits));
+        }
+    }
+
+    // unsets all bits, keeping the allocated words
+    void clear() {
+        for (Word & word : m_words) word = 0;
+    }
+
+    bool any() const {
+        for (Word word : m_words) {
+            if (word) return true;
+        }
+        return false;
+    }
+
+    // Calls f with the index of each set bit, in increasing order
+    // Bits set or reset by f at higher indices are respected
+    template <typename F>
+    void forEach(const F & f) const {
+        for (int wordI(0); wordI < int(m_words.size()); ++wordI) {
+            Word word(m_words[wordI]);
+            while (word) {
+                int bitI(lowestBit(word));
+                f(wordI * k_wordBits + bitI);
+                // reload in case the current word was changed
+                word = m_words[wordI] & (~Word(0) << bitI << 1);
+            }
+        }
+    }
+
+    private:
+
+    static int lowestBit(Word word) {
+#ifdef __GNUC__
+        return __builtin_ctzll(word);
+#else
+        int i(0);
+        while (!(word & 1)) {
+            word >>= 1;
+            ++i;
+        }
+        return i;
+#endif
+    }
+
+    Vector<Word> m_words;
+
+};
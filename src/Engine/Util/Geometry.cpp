@@ -4,6 +4,7 @@
 #include "glm/gtx/norm.hpp"
 
 #include "Util.hpp"
+#include "SSE.hpp"
 
 
 
@@ -577,6 +578,331 @@ Intersect intersect(const Ray & ray, const Capsule & cap) {
     return inter;
 }
 
+namespace {
+
+// Bit i of the result is set if f is true for shape i of the batch
+template <typename Batch, typename F>
+int testEach(const Batch & batch, const F & f) {
+    int mask(0);
+    for (int i(0); i < batch.n; ++i) {
+        if (f(batch[i])) mask |= 1 << i;
+    }
+    return mask;
+}
+
+#ifdef UTIL_SSE
+
+// One shape per lane
+struct AABox4 { __m128 minX, minY, minZ, maxX, maxY, maxZ; };
+struct Sphere4 { __m128 x, y, z, radius; };
+struct Capsule4 { __m128 x, y, z, radius, height; };
+
+AABox4 load(const AABoxBatch & boxes) {
+    return AABox4{
+        _mm_load_ps(boxes.minX), _mm_load_ps(boxes.minY), _mm_load_ps(boxes.minZ),
+        _mm_load_ps(boxes.maxX), _mm_load_ps(boxes.maxY), _mm_load_ps(boxes.maxZ)
+    };
+}
+
+Sphere4 load(const SphereBatch & spheres) {
+    return Sphere4{
+        _mm_load_ps(spheres.x), _mm_load_ps(spheres.y), _mm_load_ps(spheres.z),
+        _mm_load_ps(spheres.radius)
+    };
+}
+
+Capsule4 load(const CapsuleBatch & caps) {
+    return Capsule4{
+        _mm_load_ps(caps.x), _mm_load_ps(caps.y), _mm_load_ps(caps.z),
+        _mm_load_ps(caps.radius), _mm_load_ps(caps.height)
+    };
+}
+
+AABox4 broadcast(const AABox & box) {
+    return AABox4{
+        _mm_set1_ps(box.min.x), _mm_set1_ps(box.min.y), _mm_set1_ps(box.min.z),
+        _mm_set1_ps(box.max.x), _mm_set1_ps(box.max.y), _mm_set1_ps(box.max.z)
+    };
+}
+
+Sphere4 broadcast(const Sphere & sphere) {
+    return Sphere4{
+        _mm_set1_ps(sphere.origin.x), _mm_set1_ps(sphere.origin.y), _mm_set1_ps(sphere.origin.z),
+        _mm_set1_ps(sphere.radius)
+    };
+}
+
+Capsule4 broadcast(const Capsule & cap) {
+    return Capsule4{
+        _mm_set1_ps(cap.center.x), _mm_set1_ps(cap.center.y), _mm_set1_ps(cap.center.z),
+        _mm_set1_ps(cap.radius), _mm_set1_ps(cap.height)
+    };
+}
+
+using SSE::clamp4;
+using SSE::length2_4;
+using SSE::select4;
+using SSE::laneMask;
+
+// The kernels below perform the same operations in the same order as the
+// single versions so that the results are identical
+
+// !Util::isGE(d2, r2, k_collisionE)
+__m128 isWithin4(__m128 d2, __m128 r2) {
+    return _mm_cmpnlt_ps(_mm_sub_ps(r2, d2), _mm_set1_ps(k_collisionE));
+}
+
+__m128 collideBoxBox(const AABox4 & b1, const AABox4 & b2) {
+    __m128 x(_mm_and_ps(_mm_cmpnge_ps(b1.minX, b2.maxX), _mm_cmpnle_ps(b1.maxX, b2.minX)));
+    __m128 y(_mm_and_ps(_mm_cmpnge_ps(b1.minY, b2.maxY), _mm_cmpnle_ps(b1.maxY, b2.minY)));
+    __m128 z(_mm_and_ps(_mm_cmpnge_ps(b1.minZ, b2.maxZ), _mm_cmpnle_ps(b1.maxZ, b2.minZ)));
+    return _mm_and_ps(_mm_and_ps(x, y), z);
+}
+
+__m128 collideBoxSphere(const AABox4 & b, const Sphere4 & s) {
+    __m128 dx(_mm_sub_ps(clamp4(s.x, b.minX, b.maxX), s.x));
+    __m128 dy(_mm_sub_ps(clamp4(s.y, b.minY, b.maxY), s.y));
+    __m128 dz(_mm_sub_ps(clamp4(s.z, b.minZ, b.maxZ), s.z));
+    return isWithin4(length2_4(dx, dy, dz), _mm_mul_ps(s.radius, s.radius));
+}
+
+__m128 collideBoxCapsule(const AABox4 & b, const Capsule4 & c) {
+    __m128 boxX(clamp4(c.x, b.minX, b.maxX));
+    __m128 boxY(clamp4(c.y, b.minY, b.maxY));
+    __m128 boxZ(clamp4(c.z, b.minZ, b.maxZ));
+    __m128 halfH(_mm_mul_ps(c.height, _mm_set1_ps(0.5f)));
+    __m128 rodY(clamp4(boxY, _mm_sub_ps(c.y, halfH), _mm_add_ps(c.y, halfH)));
+    __m128 dx(_mm_sub_ps(boxX, c.x)), dy(_mm_sub_ps(boxY, rodY)), dz(_mm_sub_ps(boxZ, c.z));
+    return isWithin4(length2_4(dx, dy, dz), _mm_mul_ps(c.radius, c.radius));
+}
+
+__m128 collideSphereSphere(const Sphere4 & s1, const Sphere4 & s2) {
+    __m128 combR(_mm_add_ps(s1.radius, s2.radius));
+    __m128 dx(_mm_sub_ps(s1.x, s2.x)), dy(_mm_sub_ps(s1.y, s2.y)), dz(_mm_sub_ps(s1.z, s2.z));
+    return isWithin4(length2_4(dx, dy, dz), _mm_mul_ps(combR, combR));
+}
+
+__m128 collideSphereCapsule(const Sphere4 & s, const Capsule4 & c) {
+    __m128 combR(_mm_add_ps(c.radius, s.radius));
+    __m128 halfH(_mm_mul_ps(c.height, _mm_set1_ps(0.5f)));
+    __m128 rodY(clamp4(s.y, _mm_sub_ps(c.y, halfH), _mm_add_ps(c.y, halfH)));
+    __m128 dx(_mm_sub_ps(s.x, c.x)), dy(_mm_sub_ps(s.y, rodY)), dz(_mm_sub_ps(s.z, c.z));
+    return isWithin4(length2_4(dx, dy, dz), _mm_mul_ps(combR, combR));
+}
+
+__m128 collideCapsuleCapsule(const Capsule4 & c1, const Capsule4 & c2) {
+    __m128 combR(_mm_add_ps(c1.radius, c2.radius));
+    __m128 halfH1(_mm_mul_ps(c1.height, _mm_set1_ps(0.5f)));
+    __m128 halfH2(_mm_mul_ps(c2.height, _mm_set1_ps(0.5f)));
+    __m128 rodY1(clamp4(c2.y, _mm_sub_ps(c1.y, halfH1), _mm_add_ps(c1.y, halfH1)));
+    __m128 rodY2(clamp4(rodY1, _mm_sub_ps(c2.y, halfH2), _mm_add_ps(c2.y, halfH2)));
+    __m128 dx(_mm_sub_ps(c1.x, c2.x)), dy(_mm_sub_ps(rodY1, rodY2)), dz(_mm_sub_ps(c1.z, c2.z));
+    return isWithin4(length2_4(dx, dy, dz), _mm_mul_ps(combR, combR));
+}
+
+#endif
+
+}
+
+int collide(const AABox & box1, const AABoxBatch & boxes2) {
+#ifdef UTIL_SSE
+    return laneMask(collideBoxBox(broadcast(box1), load(boxes2)), boxes2.n);
+#else
+    return testEach(boxes2, [&](const AABox & box2) { return collide(box1, box2, nullptr); });
+#endif
+}
+
+int collide(const AABox & box1, const SphereBatch & spheres2) {
+#ifdef UTIL_SSE
+    return laneMask(collideBoxSphere(broadcast(box1), load(spheres2)), spheres2.n);
+#else
+    return testEach(spheres2, [&](const Sphere & sphere2) { return collide(box1, sphere2, nullptr); });
+#endif
+}
+
+int collide(const AABox & box1, const CapsuleBatch & caps2) {
+#ifdef UTIL_SSE
+    return laneMask(collideBoxCapsule(broadcast(box1), load(caps2)), caps2.n);
+#else
+    return testEach(caps2, [&](const Capsule & cap2) { return collide(box1, cap2, nullptr); });
+#endif
+}
+
+int collide(const Sphere & sphere1, const AABoxBatch & boxes2) {
+#ifdef UTIL_SSE
+    return laneMask(collideBoxSphere(load(boxes2), broadcast(sphere1)), boxes2.n);
+#else
+    return testEach(boxes2, [&](const AABox & box2) { return collide(box2, sphere1, nullptr); });
+#endif
+}
+
+int collide(const Sphere & sphere1, const SphereBatch & spheres2) {
+#ifdef UTIL_SSE
+    return laneMask(collideSphereSphere(broadcast(sphere1), load(spheres2)), spheres2.n);
+#else
+    return testEach(spheres2, [&](const Sphere & sphere2) { return collide(sphere1, sphere2, nullptr); });
+#endif
+}
+
+int collide(const Sphere & sphere1, const CapsuleBatch & caps2) {
+#ifdef UTIL_SSE
+    return laneMask(collideSphereCapsule(broadcast(sphere1), load(caps2)), caps2.n);
+#else
+    return testEach(caps2, [&](const Capsule & cap2) { return collide(sphere1, cap2, nullptr); });
+#endif
+}
+
+int collide(const Capsule & cap1, const AABoxBatch & boxes2) {
+#ifdef UTIL_SSE
+    return laneMask(collideBoxCapsule(load(boxes2), broadcast(cap1)), boxes2.n);
+#else
+    return testEach(boxes2, [&](const AABox & box2) { return collide(box2, cap1, nullptr); });
+#endif
+}
+
+int collide(const Capsule & cap1, const SphereBatch & spheres2) {
+#ifdef UTIL_SSE
+    return laneMask(collideSphereCapsule(load(spheres2), broadcast(cap1)), spheres2.n);
+#else
+    return testEach(spheres2, [&](const Sphere & sphere2) { return collide(sphere2, cap1, nullptr); });
+#endif
+}
+
+int collide(const Capsule & cap1, const CapsuleBatch & caps2) {
+#ifdef UTIL_SSE
+    return laneMask(collideCapsuleCapsule(broadcast(cap1), load(caps2)), caps2.n);
+#else
+    return testEach(caps2, [&](const Capsule & cap2) { return collide(cap1, cap2, nullptr); });
+#endif
+}
+
+int intersect(const Ray & ray, const AABoxBatch & boxes, float * r_dists) {
+#ifdef UTIL_SSE
+    AABox4 b(load(boxes));
+    glm::vec3 invDir_(1.0f / ray.dir);
+    __m128 posX(_mm_set1_ps(ray.pos.x)), posY(_mm_set1_ps(ray.pos.y)), posZ(_mm_set1_ps(ray.pos.z));
+    __m128 invX(_mm_set1_ps(invDir_.x)), invY(_mm_set1_ps(invDir_.y)), invZ(_mm_set1_ps(invDir_.z));
+    __m128 lowX(_mm_mul_ps(_mm_sub_ps(b.minX, posX), invX)), highX(_mm_mul_ps(_mm_sub_ps(b.maxX, posX), invX));
+    __m128 lowY(_mm_mul_ps(_mm_sub_ps(b.minY, posY), invY)), highY(_mm_mul_ps(_mm_sub_ps(b.maxY, posY), invY));
+    __m128 lowZ(_mm_mul_ps(_mm_sub_ps(b.minZ, posZ), invZ)), highZ(_mm_mul_ps(_mm_sub_ps(b.maxZ, posZ), invZ));
+    __m128 tMinor(_mm_max_ps(_mm_max_ps(_mm_min_ps(highX, lowX), _mm_min_ps(highY, lowY)), _mm_min_ps(highZ, lowZ)));
+    __m128 tMajor(_mm_min_ps(_mm_min_ps(_mm_max_ps(lowX, highX), _mm_max_ps(lowY, highY)), _mm_max_ps(lowZ, highZ)));
+
+    __m128 zero(_mm_setzero_ps());
+    __m128 hit(_mm_and_ps(_mm_cmpnle_ps(tMajor, zero), _mm_cmpgt_ps(tMajor, tMinor)));
+    // exterior hits are at the near side, interior hits at the far side
+    __m128 dist(select4(_mm_cmpge_ps(tMinor, zero), tMinor, tMajor));
+    _mm_storeu_ps(r_dists, select4(hit, dist, _mm_set1_ps(std::numeric_limits<float>::infinity())));
+    return laneMask(hit, boxes.n);
+#else
+    int mask(0);
+    for (int i(0); i < boxes.n; ++i) {
+        Intersect inter(intersect(ray, boxes[i]));
+        r_dists[i] = inter.dist;
+        if (inter.is) mask |= 1 << i;
+    }
+    return mask;
+#endif
+}
+
+int intersect(const Ray & ray, const SphereBatch & spheres, float * r_dists) {
+#ifdef UTIL_SSE
+    Sphere4 s(load(spheres));
+    __m128 dirX(_mm_set1_ps(ray.dir.x)), dirY(_mm_set1_ps(ray.dir.y)), dirZ(_mm_set1_ps(ray.dir.z));
+    __m128 cX(_mm_sub_ps(s.x, _mm_set1_ps(ray.pos.x)));
+    __m128 cY(_mm_sub_ps(s.y, _mm_set1_ps(ray.pos.y)));
+    __m128 cZ(_mm_sub_ps(s.z, _mm_set1_ps(ray.pos.z)));
+    __m128 rad2(_mm_mul_ps(s.radius, s.radius));
+    __m128 zero(_mm_setzero_ps());
+    __m128 face(_mm_cmpge_ps(_mm_sub_ps(length2_4(cX, cY, cZ), rad2), zero));
+
+    __m128 p(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dirX, cX), _mm_mul_ps(dirY, cY)), _mm_mul_ps(dirZ, cZ)));
+    __m128 d2(length2_4(
+        _mm_sub_ps(_mm_mul_ps(p, dirX), cX),
+        _mm_sub_ps(_mm_mul_ps(p, dirY), cY),
+        _mm_sub_ps(_mm_mul_ps(p, dirZ), cZ)
+    ));
+
+    // missed if facing away from the outside, or passing too far from the center
+    __m128 hit(_mm_andnot_ps(_mm_and_ps(face, _mm_cmple_ps(p, zero)), _mm_cmpnge_ps(d2, rad2)));
+    __m128 h(_mm_sqrt_ps(_mm_sub_ps(rad2, d2)));
+    __m128 dist(select4(face, _mm_sub_ps(p, h), _mm_add_ps(p, h)));
+    _mm_storeu_ps(r_dists, select4(hit, dist, _mm_set1_ps(std::numeric_limits<float>::infinity())));
+    return laneMask(hit, spheres.n);
+#else
+    int mask(0);
+    for (int i(0); i < spheres.n; ++i) {
+        Intersect inter(intersect(ray, spheres[i]));
+        r_dists[i] = inter.dist;
+        if (inter.is) mask |= 1 << i;
+    }
+    return mask;
+#endif
+}
+
+int intersect(const Ray & ray, const CapsuleBatch & caps, float * r_dists) {
+    int mask(0);
+    for (int i(0); i < caps.n; ++i) {
+        Intersect inter(intersect(ray, caps[i]));
+        r_dists[i] = inter.dist;
+        if (inter.is) mask |= 1 << i;
+    }
+    return mask;
+}
+
+namespace {
+
+// the enclosing box of the capsule
+AABox capsuleBox(const Capsule & cap) {
+    glm::vec3 ext(cap.radius, cap.radius + cap.height * 0.5f, cap.radius);
+    return AABox(cap.center - ext, cap.center + ext);
+}
+
+// the box swept by the center of an object with the given half extents
+// touching the box
+AABox inflateBox(const AABox & box, const glm::vec3 & ext) {
+    return AABox(box.min - ext, box.max + ext);
+}
+
+}
+
+Intersect sweep(const AABox & box1, const glm::vec3 & dir, const AABox & box2) {
+    return intersect(Ray(box1.center(), dir), inflateBox(box2, (box1.max - box1.min) * 0.5f));
+}
+
+Intersect sweep(const AABox & box1, const glm::vec3 & dir, const Sphere & sphere2) {
+    return sweep(box1, dir, AABox(sphere2.origin - sphere2.radius, sphere2.origin + sphere2.radius));
+}
+
+Intersect sweep(const AABox & box1, const glm::vec3 & dir, const Capsule & cap2) {
+    return sweep(box1, dir, capsuleBox(cap2));
+}
+
+Intersect sweep(const Sphere & sphere1, const glm::vec3 & dir, const AABox & box2) {
+    return intersect(Ray(sphere1.origin, dir), inflateBox(box2, glm::vec3(sphere1.radius)));
+}
+
+Intersect sweep(const Sphere & sphere1, const glm::vec3 & dir, const Sphere & sphere2) {
+    return intersect(Ray(sphere1.origin, dir), Sphere(sphere2.origin, sphere1.radius + sphere2.radius));
+}
+
+Intersect sweep(const Sphere & sphere1, const glm::vec3 & dir, const Capsule & cap2) {
+    return intersect(Ray(sphere1.origin, dir), Capsule(cap2.center, sphere1.radius + cap2.radius, cap2.height));
+}
+
+Intersect sweep(const Capsule & cap1, const glm::vec3 & dir, const AABox & box2) {
+    return intersect(Ray(cap1.center, dir), inflateBox(box2, glm::vec3(cap1.radius, cap1.radius + cap1.height * 0.5f, cap1.radius)));
+}
+
+Intersect sweep(const Capsule & cap1, const glm::vec3 & dir, const Sphere & sphere2) {
+    return intersect(Ray(cap1.center, dir), Capsule(sphere2.origin, cap1.radius + sphere2.radius, cap1.height));
+}
+
+Intersect sweep(const Capsule & cap1, const glm::vec3 & dir, const Capsule & cap2) {
+    // the minkowski sum of two upright capsules is another upright capsule
+    return intersect(Ray(cap1.center, dir), Capsule(cap2.center, cap1.radius + cap2.radius, cap1.height + cap2.height));
+}
+
 float distance(const Ray & r1, const Ray & r2) {
     glm::vec3 n(glm::cross(r1.dir, r2.dir));    
     // lines parallel
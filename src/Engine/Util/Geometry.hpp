@@ -143,6 +143,85 @@ struct Intersect {
 
 
 
+// Batches of up to k_geometryBatchSize shapes of one type, stored as a
+// structure of arrays so that one shape can be tested against all of them at
+// once. Lanes past n are ignored
+constexpr int k_geometryBatchSize = 4;
+
+struct AABoxBatch {
+
+    alignas(16) float minX[k_geometryBatchSize], minY[k_geometryBatchSize], minZ[k_geometryBatchSize];
+    alignas(16) float maxX[k_geometryBatchSize], maxY[k_geometryBatchSize], maxZ[k_geometryBatchSize];
+    int n;
+
+    AABoxBatch() :
+        minX(), minY(), minZ(),
+        maxX(), maxY(), maxZ(),
+        n(0)
+    {}
+
+    void add(const AABox & box) {
+        minX[n] = box.min.x; minY[n] = box.min.y; minZ[n] = box.min.z;
+        maxX[n] = box.max.x; maxY[n] = box.max.y; maxZ[n] = box.max.z;
+        ++n;
+    }
+
+    AABox operator[](int i) const {
+        return AABox(glm::vec3(minX[i], minY[i], minZ[i]), glm::vec3(maxX[i], maxY[i], maxZ[i]));
+    }
+
+};
+
+struct SphereBatch {
+
+    alignas(16) float x[k_geometryBatchSize], y[k_geometryBatchSize], z[k_geometryBatchSize];
+    alignas(16) float radius[k_geometryBatchSize];
+    int n;
+
+    SphereBatch() :
+        x(), y(), z(),
+        radius(),
+        n(0)
+    {}
+
+    void add(const Sphere & sphere) {
+        x[n] = sphere.origin.x; y[n] = sphere.origin.y; z[n] = sphere.origin.z;
+        radius[n] = sphere.radius;
+        ++n;
+    }
+
+    Sphere operator[](int i) const {
+        return Sphere(glm::vec3(x[i], y[i], z[i]), radius[i]);
+    }
+
+};
+
+struct CapsuleBatch {
+
+    alignas(16) float x[k_geometryBatchSize], y[k_geometryBatchSize], z[k_geometryBatchSize];
+    alignas(16) float radius[k_geometryBatchSize], height[k_geometryBatchSize];
+    int n;
+
+    CapsuleBatch() :
+        x(), y(), z(),
+        radius(), height(),
+        n(0)
+    {}
+
+    void add(const Capsule & cap) {
+        x[n] = cap.center.x; y[n] = cap.center.y; z[n] = cap.center.z;
+        radius[n] = cap.radius; height[n] = cap.height;
+        ++n;
+    }
+
+    Capsule operator[](int i) const {
+        return Capsule(glm::vec3(x[i], y[i], z[i]), radius[i], height[i]);
+    }
+
+};
+
+
+
 // Returns whether or not there is a collision
 // If delta is not null, it is set to the delta the first object should move
 // from the second object so that there is no longer a collision
@@ -158,6 +237,42 @@ Intersect intersect(const Ray & ray, const AABox & box);
 Intersect intersect(const Ray & ray, const Sphere & sphere);
 Intersect intersect(const Ray & ray, const Capsule & cap);
 
+// Batch versions of collide without a delta, using SSE where available. Bit i
+// of the result is set if the first object collides with object i of the
+// batch. Results match the single versions exactly
+int collide(const AABox & box1, const AABoxBatch & boxes2);
+int collide(const AABox & box1, const SphereBatch & spheres2);
+int collide(const AABox & box1, const CapsuleBatch & caps2);
+int collide(const Sphere & sphere1, const AABoxBatch & boxes2);
+int collide(const Sphere & sphere1, const SphereBatch & spheres2);
+int collide(const Sphere & sphere1, const CapsuleBatch & caps2);
+int collide(const Capsule & cap1, const AABoxBatch & boxes2);
+int collide(const Capsule & cap1, const SphereBatch & spheres2);
+int collide(const Capsule & cap1, const CapsuleBatch & caps2);
+
+// Batch versions of intersect. Bit i of the result is set if the ray hits
+// object i of the batch, from either side. r_dists must hold
+// k_geometryBatchSize floats, and is set to the distance of each hit, or
+// infinity. Capsules are intersected one at a time
+int intersect(const Ray & ray, const AABoxBatch & boxes, float * r_dists);
+int intersect(const Ray & ray, const SphereBatch & spheres, float * r_dists);
+int intersect(const Ray & ray, const CapsuleBatch & caps, float * r_dists);
+
+// Sweeps the first object along the unit direction and calculates the
+// intersection of its center with the surface where it first touches the
+// second object. A sweep that starts in collision is not a face intersection
+// Sweeps of or against boxes are exact for box-box, otherwise conservative,
+// treating the round object as its enclosing box
+Intersect sweep(const AABox & box1, const glm::vec3 & dir, const AABox & box2);
+Intersect sweep(const AABox & box1, const glm::vec3 & dir, const Sphere & sphere2);
+Intersect sweep(const AABox & box1, const glm::vec3 & dir, const Capsule & cap2);
+Intersect sweep(const Sphere & sphere1, const glm::vec3 & dir, const AABox & box2);
+Intersect sweep(const Sphere & sphere1, const glm::vec3 & dir, const Sphere & sphere2);
+Intersect sweep(const Sphere & sphere1, const glm::vec3 & dir, const Capsule & cap2);
+Intersect sweep(const Capsule & cap1, const glm::vec3 & dir, const AABox & box2);
+Intersect sweep(const Capsule & cap1, const glm::vec3 & dir, const Sphere & sphere2);
+Intersect sweep(const Capsule & cap1, const glm::vec3 & dir, const Capsule & cap2);
+
 // Distance between nearest points on lines defined by rays
 float distance(const Ray & r1, const Ray & r2);
 // returns the two points nearest each other on two lines defined by rays
@@ -0,0 +1,67 @@
+#include "JobThread.hpp"
+
+#ifdef USE_RPMALLOC
+#include "ThirdParty/CoherentLabs_rpmalloc/rpmalloc.h"
+#endif
+
+
+
+JobThread::JobThread() :
+    m_mutex(),
+    m_startCV(),
+    m_doneCV(),
+    m_f(),
+    m_isBusy(false),
+    m_isQuitting(false),
+    m_worker(&JobThread::work, this)
+{}
+
+JobThread::~JobThread() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isQuitting = true;
+    }
+    m_startCV.notify_one();
+    m_worker.join();
+}
+
+void JobThread::start(std::function<void()> f) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_f = std::move(f);
+        m_isBusy = true;
+    }
+    m_startCV.notify_one();
+}
+
+void JobThread::wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCV.wait(lock, [&]() { return !m_isBusy; });
+}
+
+void JobThread::work() {
+#ifdef USE_RPMALLOC
+    coherent_rpmalloc::rpmalloc_thread_initialize();
+#endif
+
+    while (true) {
+        std::function<void()> f;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_startCV.wait(lock, [&]() { return m_isQuitting || m_isBusy; });
+            if (m_isQuitting) {
+                return;
+            }
+            f = std::move(m_f);
+        }
+
+        f();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_isBusy = false;
+        }
+        m_doneCV.notify_one();
+    }
+}
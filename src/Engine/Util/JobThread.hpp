@@ -0,0 +1,46 @@
+#pragma once
+
+
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+
+
+// A single worker thread that runs one job at a time alongside the calling
+// thread, which waits on it before starting the next
+class JobThread {
+
+    public:
+
+    JobThread();
+    JobThread(const JobThread & other) = delete;
+    JobThread(JobThread && other) = delete;
+
+    ~JobThread();
+
+    JobThread & operator=(const JobThread & other) = delete;
+    JobThread & operator=(JobThread && other) = delete;
+
+    // Starts f on the worker and returns immediately. The previous job must
+    // have been waited on
+    void start(std::function<void()> f);
+
+    // Returns once the current job, if any, is done
+    void wait();
+
+    private:
+
+    void work();
+
+    std::mutex m_mutex;
+    std::condition_variable m_startCV;
+    std::condition_variable m_doneCV;
+    std::function<void()> m_f;
+    bool m_isBusy;
+    bool m_isQuitting;
+    std::thread m_worker; // last, so it starts once everything else is set
+
+};
@@ -18,4 +18,16 @@ int InitializeMemory::initialized = 0;
 
 }
 
-#endif
\ No newline at end of file
+#endif
+
+
+
+#ifdef COUNT_ALLOCATIONS
+
+namespace detail {
+
+std::atomic<unsigned long long> nAllocations(0);
+
+}
+
+#endif
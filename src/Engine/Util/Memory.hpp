@@ -15,6 +15,10 @@
 #include <unordered_map>
 #include <cstdlib>
 
+#ifdef COUNT_ALLOCATIONS
+#include <atomic>
+#endif
+
 
 #ifdef USE_RPMALLOC
 
@@ -49,7 +53,23 @@ static InitializeMemory f_initializeMemory;
 
 
 
+#ifdef COUNT_ALLOCATIONS
+
+namespace detail {
+
+// number of calls to allocate, for benchmarks
+extern std::atomic<unsigned long long> nAllocations;
+
+}
+
+#endif
+
+
+
 inline void * allocate(size_t size) {
+#ifdef COUNT_ALLOCATIONS
+    ++detail::nAllocations;
+#endif
 #ifdef USE_RPMALLOC
     return coherent_rpmalloc::rpmalloc(size);
 #else
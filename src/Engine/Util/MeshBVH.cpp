@@ -0,0 +1,649 @@
+#include "MeshBVH.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "glm/gtx/component_wise.hpp"
+#include "glm/gtx/norm.hpp"
+
+#include "Util.hpp"
+
+
+
+namespace {
+
+constexpr int k_maxDepth = 64;
+
+AABox triangleBox(const Triangle & tri) {
+    return AABox(glm::min(glm::min(tri.a, tri.b), tri.c), glm::max(glm::max(tri.a, tri.b), tri.c));
+}
+
+AABox merge(const AABox & box1, const AABox & box2) {
+    return AABox(glm::min(box1.min, box2.min), glm::max(box1.max, box2.max));
+}
+
+bool overlaps(const AABox & box1, const AABox & box2) {
+    return
+        box1.min.x <= box2.max.x && box2.min.x <= box1.max.x &&
+        box1.min.y <= box2.max.y && box2.min.y <= box1.max.y &&
+        box1.min.z <= box2.max.z && box2.min.z <= box1.max.z;
+}
+
+// whether the ray hits the box before maxDist, counting a ray starting inside
+bool hitsBox(const Ray & ray, const AABox & box, float maxDist) {
+    float near(0.0f), far(maxDist);
+    for (int i(0); i < 3; ++i) {
+        if (ray.dir[i] == 0.0f) {
+            if (ray.pos[i] < box.min[i] || ray.pos[i] > box.max[i]) return false;
+            continue;
+        }
+        float inv(1.0f / ray.dir[i]);
+        float t1((box.min[i] - ray.pos[i]) * inv), t2((box.max[i] - ray.pos[i]) * inv);
+        if (t1 > t2) std::swap(t1, t2);
+        near = glm::max(near, t1);
+        far = glm::min(far, t2);
+        if (near > far) return false;
+    }
+    return true;
+}
+
+// Moller-Trumbore, returns the distance along the ray or infinity
+float intersectTriangle(const Ray & ray, const Triangle & tri) {
+    glm::vec3 e1(tri.b - tri.a), e2(tri.c - tri.a);
+    glm::vec3 p(glm::cross(ray.dir, e2));
+    float det(glm::dot(e1, p));
+    if (glm::abs(det) < 1.0e-12f) {
+        return Util::infinity();
+    }
+    float invDet(1.0f / det);
+    glm::vec3 s(ray.pos - tri.a);
+    float u(glm::dot(s, p) * invDet);
+    if (u < 0.0f || u > 1.0f) {
+        return Util::infinity();
+    }
+    glm::vec3 q(glm::cross(s, e1));
+    float v(glm::dot(ray.dir, q) * invDet);
+    if (v < 0.0f || u + v > 1.0f) {
+        return Util::infinity();
+    }
+    float t(glm::dot(e2, q) * invDet);
+    return t >= 0.0f ? t : Util::infinity();
+}
+
+// the point on the triangle nearest p, from Real-Time Collision Detection 5.1.5
+glm::vec3 nearestPoint(const Triangle & tri, const glm::vec3 & p) {
+    glm::vec3 ab(tri.b - tri.a), ac(tri.c - tri.a), ap(p - tri.a);
+    float d1(glm::dot(ab, ap)), d2(glm::dot(ac, ap));
+    if (d1 <= 0.0f && d2 <= 0.0f) return tri.a;
+
+    glm::vec3 bp(p - tri.b);
+    float d3(glm::dot(ab, bp)), d4(glm::dot(ac, bp));
+    if (d3 >= 0.0f && d4 <= d3) return tri.b;
+
+    float vc(d1 * d4 - d3 * d2);
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) return tri.a + ab * (d1 / (d1 - d3));
+
+    glm::vec3 cp(p - tri.c);
+    float d5(glm::dot(ab, cp)), d6(glm::dot(ac, cp));
+    if (d6 >= 0.0f && d5 <= d6) return tri.c;
+
+    float vb(d5 * d2 - d1 * d6);
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) return tri.a + ac * (d2 / (d2 - d6));
+
+    float va(d3 * d6 - d5 * d4);
+    if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f) return tri.b + (tri.c - tri.b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+    float denom(1.0f / (va + vb + vc));
+    return tri.a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+glm::vec3 nearestPoint(const glm::vec3 & s0, const glm::vec3 & s1, const glm::vec3 & p) {
+    glm::vec3 d(s1 - s0);
+    float d2(glm::length2(d));
+    if (d2 == 0.0f) {
+        return s0;
+    }
+    return s0 + d * glm::clamp(glm::dot(p - s0, d) / d2, 0.0f, 1.0f);
+}
+
+// the nearest points r_c1 on segment p1q1 and r_c2 on segment p2q2, from
+// Real-Time Collision Detection 5.1.9
+void nearestPoints(const glm::vec3 & p1, const glm::vec3 & q1, const glm::vec3 & p2, const glm::vec3 & q2, glm::vec3 & r_c1, glm::vec3 & r_c2) {
+    glm::vec3 d1(q1 - p1), d2(q2 - p2), r(p1 - p2);
+    float a(glm::dot(d1, d1)), e(glm::dot(d2, d2)), f(glm::dot(d2, r));
+    float s(0.0f), t(0.0f);
+    if (Util::isZero(a) && Util::isZero(e)) {
+        r_c1 = p1;
+        r_c2 = p2;
+        return;
+    }
+    if (Util::isZero(a)) {
+        t = glm::clamp(f / e, 0.0f, 1.0f);
+    }
+    else {
+        float c(glm::dot(d1, r));
+        if (Util::isZero(e)) {
+            s = glm::clamp(-c / a, 0.0f, 1.0f);
+        }
+        else {
+            float b(glm::dot(d1, d2));
+            float denom(a * e - b * b);
+            // parallel segments pick any s, and t then decides
+            s = denom > 0.0f ? glm::clamp((b * f - c * e) / denom, 0.0f, 1.0f) : 0.0f;
+            t = (b * s + f) / e;
+            if (t < 0.0f) {
+                t = 0.0f;
+                s = glm::clamp(-c / a, 0.0f, 1.0f);
+            }
+            else if (t > 1.0f) {
+                t = 1.0f;
+                s = glm::clamp((b - c) / a, 0.0f, 1.0f);
+            }
+        }
+    }
+    r_c1 = p1 + d1 * s;
+    r_c2 = p2 + d2 * t;
+}
+
+// tracks the most positive and most negative delta per component, which
+// together composite as in CollisionSystem
+struct DeltaSum {
+
+    glm::vec3 pos, neg;
+    bool is;
+
+    DeltaSum() : pos(), neg(), is(false) {}
+
+    void add(const glm::vec3 & delta) {
+        pos = glm::max(pos, delta);
+        neg = glm::min(neg, delta);
+        is = true;
+    }
+
+    glm::vec3 get() const { return pos + neg; }
+
+};
+
+// the delta to push the sphere from its nearest point p on a surface with normal n
+glm::vec3 pushSphere(const Sphere & sphere, const glm::vec3 & p, const glm::vec3 & n) {
+    glm::vec3 dVec(sphere.origin - p);
+    float d2(glm::length2(dVec));
+    if (Util::isZero(d2)) {
+        return n * sphere.radius;
+    }
+    float d(std::sqrt(d2));
+    return (sphere.radius - d) * (dVec / d);
+}
+
+bool collideTriangle(const Sphere & sphere, const Triangle & tri, glm::vec3 * delta) {
+    glm::vec3 p(nearestPoint(tri, sphere.origin));
+    if (glm::length2(sphere.origin - p) >= sphere.radius * sphere.radius) {
+        return false;
+    }
+    if (delta) {
+        *delta = pushSphere(sphere, p, Util::safeNorm(glm::cross(tri.b - tri.a, tri.c - tri.a)));
+    }
+    return true;
+}
+
+bool collideTriangle(const Capsule & cap, const Triangle & tri, glm::vec3 * delta) {
+    glm::vec3 s0(cap.center), s1(cap.center);
+    s0.y -= cap.height * 0.5f;
+    s1.y += cap.height * 0.5f;
+    glm::vec3 n(Util::safeNorm(glm::cross(tri.b - tri.a, tri.c - tri.a)));
+
+    // the segment passes through the triangle, so push the capsule out to
+    // whichever side its center is on
+    glm::vec3 seg(s1 - s0);
+    float segLength(cap.height);
+    if (segLength > 0.0f && intersectTriangle(Ray(s0, seg / segLength), tri) <= segLength) {
+        if (delta) {
+            float side(glm::dot(cap.center - tri.a, n) >= 0.0f ? 1.0f : -1.0f);
+            float depth(glm::max(-side * glm::dot(s0 - tri.a, n), -side * glm::dot(s1 - tri.a, n)));
+            *delta = side * (depth + cap.radius) * n;
+        }
+        return true;
+    }
+
+    // the segment doesn't cross the triangle, so the nearest points are
+    // between an end of the segment and the face, or the segment and an edge
+    glm::vec3 q(s0), p(nearestPoint(tri, s0));
+    float dist2(glm::length2(q - p));
+    auto consider([&](const glm::vec3 & segP, const glm::vec3 & triP) {
+        float d2(glm::length2(segP - triP));
+        if (d2 < dist2) {
+            q = segP;
+            p = triP;
+            dist2 = d2;
+        }
+    });
+    consider(s1, nearestPoint(tri, s1));
+    const glm::vec3 * verts[4]{ &tri.a, &tri.b, &tri.c, &tri.a };
+    for (int i(0); i < 3; ++i) {
+        glm::vec3 segP, triP;
+        nearestPoints(s0, s1, *verts[i], *verts[i + 1], segP, triP);
+        consider(segP, triP);
+    }
+    if (dist2 >= cap.radius * cap.radius) {
+        return false;
+    }
+    if (delta) {
+        *delta = pushSphere(Sphere(q, cap.radius), p, n);
+    }
+    return true;
+}
+
+// separating axis test, from Akenine-Moller's box-triangle overlap. The delta
+// is along the axis of least overlap
+bool collideTriangle(const AABox & box, const Triangle & tri, glm::vec3 * delta) {
+    glm::vec3 center(box.center()), ext((box.max - box.min) * 0.5f);
+    glm::vec3 v[3]{ tri.a - center, tri.b - center, tri.c - center };
+    glm::vec3 edges[3]{ v[1] - v[0], v[2] - v[1], v[0] - v[2] };
+
+    glm::vec3 axes[13];
+    int nAxes(0);
+    axes[nAxes++] = glm::vec3(1.0f, 0.0f, 0.0f);
+    axes[nAxes++] = glm::vec3(0.0f, 1.0f, 0.0f);
+    axes[nAxes++] = glm::vec3(0.0f, 0.0f, 1.0f);
+    axes[nAxes++] = glm::cross(edges[0], edges[1]);
+    for (int i(0); i < 3; ++i) {
+        for (int j(0); j < 3; ++j) {
+            axes[nAxes++] = glm::cross(axes[i], edges[j]);
+        }
+    }
+
+    float minOverlap(Util::infinity());
+    glm::vec3 minDelta;
+    for (int i(0); i < nAxes; ++i) {
+        float length(glm::length(axes[i]));
+        if (length < 1.0e-6f) {
+            continue;
+        }
+        glm::vec3 axis(axes[i] / length);
+        float p0(glm::dot(v[0], axis)), p1(glm::dot(v[1], axis)), p2(glm::dot(v[2], axis));
+        float triMin(glm::min(glm::min(p0, p1), p2)), triMax(glm::max(glm::max(p0, p1), p2));
+        float r(glm::dot(ext, glm::abs(axis)));
+        if (triMin >= r || triMax <= -r) {
+            return false;
+        }
+        // distances to move the box along -axis and +axis to separate
+        float down(r - triMin), up(triMax + r);
+        if (down < minOverlap) {
+            minOverlap = down;
+            minDelta = -down * axis;
+        }
+        if (up < minOverlap) {
+            minOverlap = up;
+            minDelta = up * axis;
+        }
+    }
+
+    if (delta) *delta = minDelta;
+    return true;
+}
+
+// distance along the ray to the capsule with the given end points, or infinity
+// from https://www.iquilezles.org/www/articles/intersectors/intersectors.htm
+float intersectSegmentCapsule(const Ray & ray, const glm::vec3 & pa, const glm::vec3 & pb, float r) {
+    glm::vec3 ba(pb - pa), oa(ray.pos - pa);
+    float baba(glm::dot(ba, ba));
+    float bard(glm::dot(ba, ray.dir));
+    float baoa(glm::dot(ba, oa));
+    float rdoa(glm::dot(ray.dir, oa));
+    float oaoa(glm::dot(oa, oa));
+    float a(baba - bard * bard);
+    float b(baba * rdoa - baoa * bard);
+    float c(baba * oaoa - baoa * baoa - r * r * baba);
+    float h(b * b - a * c);
+    if (h < 0.0f) {
+        return Util::infinity();
+    }
+
+    // body, unless the ray runs parallel to the segment
+    if (a > 1.0e-12f) {
+        float t((-b - std::sqrt(h)) / a);
+        float y(baoa + t * bard);
+        if (y > 0.0f && y < baba) {
+            return t >= 0.0f ? t : Util::infinity();
+        }
+    }
+
+    // caps
+    float best(Util::infinity());
+    const glm::vec3 * ends[2]{ &pa, &pb };
+    for (int i(0); i < 2; ++i) {
+        glm::vec3 oc(ray.pos - *ends[i]);
+        float cb(glm::dot(ray.dir, oc));
+        float cc(glm::dot(oc, oc) - r * r);
+        float ch(cb * cb - cc);
+        if (ch > 0.0f) {
+            float t(-cb - std::sqrt(ch));
+            if (t >= 0.0f && t < best) best = t;
+        }
+    }
+    return best;
+}
+
+// distance along the ray where the sphere first touches the triangle, or infinity
+float sweepTriangle(const Sphere & sphere, const glm::vec3 & dir, const Triangle & tri, glm::vec3 & r_norm) {
+    Ray ray(sphere.origin, dir);
+    float best(Util::infinity());
+
+    // face
+    glm::vec3 n(Util::safeNorm(glm::cross(tri.b - tri.a, tri.c - tri.a)));
+    float dist0(glm::dot(sphere.origin - tri.a, n));
+    float side(dist0 >= 0.0f ? 1.0f : -1.0f);
+    float dn(glm::dot(dir, n));
+    if (dn * side < 0.0f) {
+        float t((side * sphere.radius - dist0) / dn);
+        if (t >= 0.0f) {
+            // whether the contact point is on the inside of each edge
+            glm::vec3 contact(ray.pos + t * dir - side * sphere.radius * n);
+            if (
+                glm::dot(glm::cross(tri.b - tri.a, contact - tri.a), n) >= 0.0f &&
+                glm::dot(glm::cross(tri.c - tri.b, contact - tri.b), n) >= 0.0f &&
+                glm::dot(glm::cross(tri.a - tri.c, contact - tri.c), n) >= 0.0f
+            ) {
+                best = t;
+                r_norm = side * n;
+            }
+        }
+    }
+
+    // edges and vertices
+    const glm::vec3 * verts[4]{ &tri.a, &tri.b, &tri.c, &tri.a };
+    for (int i(0); i < 3; ++i) {
+        float t(intersectSegmentCapsule(ray, *verts[i], *verts[i + 1], sphere.radius));
+        if (t < best) {
+            best = t;
+            glm::vec3 pos(ray.pos + t * dir);
+            r_norm = Util::safeNorm(pos - nearestPoint(*verts[i], *verts[i + 1], pos));
+        }
+    }
+
+    return best;
+}
+
+// distance along the ray where the capsule first touches the triangle, or
+// infinity. The first contact is where a hemisphere meets the triangle, a
+// vertex meets the capsule, or an edge meets the cylinder between the ends
+float sweepTriangle(const Capsule & cap, const glm::vec3 & dir, const Triangle & tri, glm::vec3 & r_norm) {
+    glm::vec3 s0(cap.center), s1(cap.center);
+    s0.y -= cap.height * 0.5f;
+    s1.y += cap.height * 0.5f;
+
+    // hemispheres
+    glm::vec3 norm;
+    float best(sweepTriangle(Sphere(s0, cap.radius), dir, tri, r_norm));
+    float t(sweepTriangle(Sphere(s1, cap.radius), dir, tri, norm));
+    if (t < best) {
+        best = t;
+        r_norm = norm;
+    }
+
+    // vertices, as rays back into the capsule
+    const glm::vec3 * verts[4]{ &tri.a, &tri.b, &tri.c, &tri.a };
+    for (int i(0); i < 3; ++i) {
+        t = intersectSegmentCapsule(Ray(*verts[i], -dir), s0, s1, cap.radius);
+        if (t < best) {
+            best = t;
+            r_norm = Util::safeNorm(nearestPoint(s0 + t * dir, s1 + t * dir, *verts[i]) - *verts[i]);
+        }
+    }
+
+    // edges against the cylinder, which touch once the lines through the
+    // segment and the edge are a radius apart, if their nearest points are
+    // then within both
+    for (int i(0); i < 3; ++i) {
+        glm::vec3 n(glm::cross(s1 - s0, *verts[i + 1] - *verts[i]));
+        float length(glm::length(n));
+        if (length < 1.0e-6f) {
+            continue;
+        }
+        n /= length;
+        float dist0(glm::dot(s0 - *verts[i], n));
+        float side(dist0 >= 0.0f ? 1.0f : -1.0f);
+        float dn(glm::dot(dir, n));
+        if (dn * side >= 0.0f) {
+            continue;
+        }
+        t = (side * cap.radius - dist0) / dn;
+        if (t < 0.0f || t >= best) {
+            continue;
+        }
+        glm::vec3 c1, c2;
+        nearestPoints(s0 + t * dir, s1 + t * dir, *verts[i], *verts[i + 1], c1, c2);
+        if (glm::distance(c1, c2) <= cap.radius * 1.001f) {
+            best = t;
+            r_norm = side * n;
+        }
+    }
+
+    return best;
+}
+
+}
+
+
+
+constexpr int MeshBVH::k_maxLeafSize;
+
+void MeshBVH::build(const Vector<Triangle> & triangles) {
+    clear();
+    if (triangles.empty()) {
+        return;
+    }
+
+    m_triangles = triangles;
+    int n(int(m_triangles.size()));
+    Vector<glm::vec3> centroids(n);
+    Vector<int> order(n);
+    for (int i(0); i < n; ++i) {
+        centroids[i] = (m_triangles[i].a + m_triangles[i].b + m_triangles[i].c) * (1.0f / 3.0f);
+        order[i] = i;
+    }
+    // a binary tree with leaves of at least half the max size
+    m_nodes.reserve(4 * n / k_maxLeafSize + 1);
+    buildNode(0, n, order, centroids);
+
+    // leaves refer to contiguous ranges of triangles
+    Vector<Triangle> ordered(n);
+    for (int i(0); i < n; ++i) {
+        ordered[i] = m_triangles[order[i]];
+    }
+    m_triangles.swap(ordered);
+}
+
+void MeshBVH::clear() {
+    m_nodes.clear();
+    m_triangles.clear();
+}
+
+int MeshBVH::buildNode(int start, int end, Vector<int> & order, const Vector<glm::vec3> & centroids) {
+    int nodeI(int(m_nodes.size()));
+    m_nodes.emplace_back();
+
+    AABox box(triangleBox(m_triangles[order[start]]));
+    AABox centroidBox(centroids[order[start]], centroids[order[start]]);
+    for (int i(start + 1); i < end; ++i) {
+        box = merge(box, triangleBox(m_triangles[order[i]]));
+        centroidBox.min = glm::min(centroidBox.min, centroids[order[i]]);
+        centroidBox.max = glm::max(centroidBox.max, centroids[order[i]]);
+    }
+    m_nodes[nodeI].box = box;
+
+    // split at the median centroid along the longest axis
+    glm::vec3 span(centroidBox.max - centroidBox.min);
+    int axis(span.x >= span.y && span.x >= span.z ? 0 : span.y >= span.z ? 1 : 2);
+    if (end - start <= k_maxLeafSize || span[axis] == 0.0f) {
+        m_nodes[nodeI].start = start;
+        m_nodes[nodeI].count = end - start;
+        return nodeI;
+    }
+    int mid((start + end) / 2);
+    std::nth_element(order.begin() + start, order.begin() + mid, order.begin() + end, [&](int i1, int i2) {
+        return centroids[i1][axis] < centroids[i2][axis];
+    });
+
+    buildNode(start, mid, order, centroids);
+    int second(buildNode(mid, end, order, centroids));
+    m_nodes[nodeI].start = second;
+    m_nodes[nodeI].count = 0;
+    return nodeI;
+}
+
+template <typename F>
+void MeshBVH::forEachNear(const AABox & box, const F & f) const {
+    if (m_nodes.empty()) {
+        return;
+    }
+
+    int stack[k_maxDepth];
+    int size(0);
+    stack[size++] = 0;
+    while (size) {
+        const Node & node(m_nodes[stack[--size]]);
+        if (!overlaps(node.box, box)) {
+            continue;
+        }
+        if (node.count) {
+            for (int i(node.start); i < node.start + node.count; ++i) {
+                if (overlaps(triangleBox(m_triangles[i]), box)) {
+                    f(m_triangles[i]);
+                }
+            }
+        }
+        else {
+            stack[size++] = node.start;
+            stack[size++] = int(&node - m_nodes.data()) + 1;
+        }
+    }
+}
+
+Intersect MeshBVH::intersect(const Ray & ray) const {
+    if (m_nodes.empty()) {
+        return Intersect();
+    }
+
+    float best(Util::infinity());
+    const Triangle * bestTri(nullptr);
+    int stack[k_maxDepth];
+    int size(0);
+    stack[size++] = 0;
+    while (size) {
+        const Node & node(m_nodes[stack[--size]]);
+        if (!hitsBox(ray, node.box, best)) {
+            continue;
+        }
+        if (node.count) {
+            for (int i(node.start); i < node.start + node.count; ++i) {
+                float t(intersectTriangle(ray, m_triangles[i]));
+                if (t < best) {
+                    best = t;
+                    bestTri = &m_triangles[i];
+                }
+            }
+        }
+        else {
+            stack[size++] = node.start;
+            stack[size++] = int(&node - m_nodes.data()) + 1;
+        }
+    }
+
+    if (!bestTri) {
+        return Intersect();
+    }
+    glm::vec3 norm(Util::safeNorm(glm::cross(bestTri->b - bestTri->a, bestTri->c - bestTri->a)));
+    if (glm::dot(norm, ray.dir) > 0.0f) {
+        norm = -norm;
+    }
+    return Intersect(best, ray.pos + best * ray.dir, norm, true);
+}
+
+bool MeshBVH::collide(const AABox & box, glm::vec3 * delta) const {
+    DeltaSum sum;
+    glm::vec3 d;
+    forEachNear(box, [&](const Triangle & tri) {
+        if ((delta || !sum.is) && collideTriangle(box, tri, delta ? &d : nullptr)) {
+            sum.add(d);
+        }
+    });
+    if (sum.is && delta) *delta = sum.get();
+    return sum.is;
+}
+
+bool MeshBVH::collide(const Sphere & sphere, glm::vec3 * delta) const {
+    DeltaSum sum;
+    glm::vec3 d;
+    forEachNear(AABox(sphere.origin - sphere.radius, sphere.origin + sphere.radius), [&](const Triangle & tri) {
+        if ((delta || !sum.is) && collideTriangle(sphere, tri, delta ? &d : nullptr)) {
+            sum.add(d);
+        }
+    });
+    if (sum.is && delta) *delta = sum.get();
+    return sum.is;
+}
+
+bool MeshBVH::collide(const Capsule & cap, glm::vec3 * delta) const {
+    DeltaSum sum;
+    glm::vec3 d;
+    glm::vec3 ext(cap.radius, cap.radius + cap.height * 0.5f, cap.radius);
+    forEachNear(AABox(cap.center - ext, cap.center + ext), [&](const Triangle & tri) {
+        if ((delta || !sum.is) && collideTriangle(cap, tri, delta ? &d : nullptr)) {
+            sum.add(d);
+        }
+    });
+    if (sum.is && delta) *delta = sum.get();
+    return sum.is;
+}
+
+template <typename T>
+Intersect MeshBVH::sweepShape(const T & shape, const glm::vec3 & ext, const Ray & ray) const {
+    if (m_nodes.empty()) {
+        return Intersect();
+    }
+
+    const glm::vec3 & dir(ray.dir);
+    float best(Util::infinity());
+    glm::vec3 bestNorm;
+    int stack[k_maxDepth];
+    int size(0);
+    stack[size++] = 0;
+    while (size) {
+        const Node & node(m_nodes[stack[--size]]);
+        if (!hitsBox(ray, AABox(node.box.min - ext, node.box.max + ext), best)) {
+            continue;
+        }
+        if (node.count) {
+            for (int i(node.start); i < node.start + node.count; ++i) {
+                const Triangle & tri(m_triangles[i]);
+                if (collideTriangle(shape, tri, nullptr)) {
+                    continue;
+                }
+                glm::vec3 norm;
+                float t(sweepTriangle(shape, dir, tri, norm));
+                if (t < best) {
+                    best = t;
+                    bestNorm = norm;
+                }
+            }
+        }
+        else {
+            stack[size++] = node.start;
+            stack[size++] = int(&node - m_nodes.data()) + 1;
+        }
+    }
+
+    if (best == Util::infinity()) {
+        return Intersect();
+    }
+    return Intersect(best, ray.pos + best * dir, bestNorm, true);
+}
+
+Intersect MeshBVH::sweep(const Sphere & sphere, const glm::vec3 & dir) const {
+    return sweepShape(sphere, glm::vec3(sphere.radius), Ray(sphere.origin, dir));
+}
+
+Intersect MeshBVH::sweep(const Capsule & cap, const glm::vec3 & dir) const {
+    return sweepShape(cap, glm::vec3(cap.radius, cap.radius + cap.height * 0.5f, cap.radius), Ray(cap.center, dir));
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+
+
+#include "glm/glm.hpp"
+
+#include "Memory.hpp"
+#include "Util/Geometry.hpp"
+
+
+
+struct Triangle {
+
+    glm::vec3 a, b, c;
+
+    Triangle() :
+        a(), b(), c()
+    {}
+
+    Triangle(const glm::vec3 & a, const glm::vec3 & b, const glm::vec3 & c) :
+        a(a), b(b), c(c)
+    {}
+
+};
+
+
+
+// A bounding volume hierarchy over a fixed set of triangles, stored as a flat
+// array of nodes in depth first order. Triangles are two sided
+class MeshBVH {
+
+    struct Node {
+
+        AABox box;
+        int start; // first triangle of a leaf, or second child of an interior node
+        int count; // number of triangles of a leaf, or 0 for an interior node, whose first child follows it
+
+    };
+
+    public:
+
+    static constexpr int k_maxLeafSize = 4;
+
+    MeshBVH() = default;
+
+    // Replaces any previous contents
+    void build(const Vector<Triangle> & triangles);
+
+    void clear();
+
+    bool empty() const { return m_nodes.empty(); }
+
+    // the box enclosing all triangles
+    AABox box() const { return m_nodes.empty() ? AABox() : m_nodes.front().box; }
+
+    int nTriangles() const { return int(m_triangles.size()); }
+    int nNodes() const { return int(m_nodes.size()); }
+
+    // The nearest triangle hit by the ray
+    Intersect intersect(const Ray & ray) const;
+
+    // The same as the Geometry versions, where the mesh is the second object
+    // and delta is the delta the shape should move from the mesh. Deltas from
+    // each touching triangle are composited per component
+    bool collide(const AABox & box, glm::vec3 * delta) const;
+    bool collide(const Sphere & sphere, glm::vec3 * delta) const;
+    bool collide(const Capsule & cap, glm::vec3 * delta) const;
+
+    // Sweeps the sphere along the unit direction and calculates the
+    // intersection of its center with the surface where it first touches a
+    // triangle. Triangles the sphere starts in collision with are ignored
+    Intersect sweep(const Sphere & sphere, const glm::vec3 & dir) const;
+    // The same for the capsule's center
+    Intersect sweep(const Capsule & cap, const glm::vec3 & dir) const;
+
+    private:
+
+    int buildNode(int start, int end, Vector<int> & order, const Vector<glm::vec3> & centroids);
+
+    // calls f with each triangle whose box overlaps the given box
+    template <typename F> void forEachNear(const AABox & box, const F & f) const;
+
+    // sweeps a shape whose box has the given half extents from the ray's origin
+    template <typename T> Intersect sweepShape(const T & shape, const glm::vec3 & ext, const Ray & ray) const;
+
+    Vector<Node> m_nodes;
+    Vector<Triangle> m_triangles;
+
+};
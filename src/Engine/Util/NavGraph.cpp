@@ -0,0 +1,525 @@
+#include "NavGraph.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+
+
+namespace {
+
+// the rounded x and z of a position, packed together
+uint64_t gridKey(const glm::vec3 & p) {
+    return (uint64_t(uint32_t(int32_t(std::round(p.x)))) << 32) | uint64_t(uint32_t(int32_t(std::round(p.z))));
+}
+
+float manhattan(const glm::vec3 & a, const glm::vec3 & b) {
+    return std::abs(a.x - b.x) + std::abs(a.y - b.y) + std::abs(a.z - b.z);
+}
+
+template <typename T>
+void writeArray(std::ofstream & file, const Vector<T> & array) {
+    file.write(reinterpret_cast<const char *>(array.data()), std::streamsize(array.size() * sizeof(T)));
+}
+
+// FNV-1a, continuing from h, but taking eight bytes at a time as it's run
+// over whole files
+uint64_t hashBytes(const void * bytes, size_t n, uint64_t h = 0xCBF29CE484222325) {
+    const unsigned char * it(static_cast<const unsigned char *>(bytes));
+    for (; n >= sizeof(uint64_t); n -= sizeof(uint64_t), it += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, it, sizeof(word));
+        h = (h ^ word) * 0x100000001B3;
+    }
+    for (; n; --n, ++it) {
+        h = (h ^ *it) * 0x100000001B3;
+    }
+    return h;
+}
+
+// the whole of the file, as is
+bool readBytes(const String & fileName, std::string & r_bytes) {
+    std::ifstream file(fileName.c_str(), std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    r_bytes.resize(size_t(file.tellg()));
+    file.seekg(0);
+    return bool(file.read(&r_bytes[0], std::streamsize(r_bytes.size())));
+}
+
+// copies n elements from r_bytes into r_array and moves r_bytes past them
+template <typename T>
+void readArray(const char *& r_bytes, size_t n, Vector<T> & r_array) {
+    r_array.resize(n);
+    std::memcpy(r_array.data(), r_bytes, n * sizeof(T));
+    r_bytes += n * sizeof(T);
+}
+
+}
+
+
+
+constexpr uint32_t NavGraph::k_invalid;
+constexpr float NavGraph::k_cellSize;
+constexpr uint32_t NavGraph::k_magic;
+constexpr uint32_t NavGraph::k_version;
+constexpr uint32_t NavField::k_unreached;
+
+String NavGraph::withExtension(const String & fileName, const char * extension) {
+    size_t dotI(fileName.find_last_of('.'));
+    size_t slashI(fileName.find_last_of("/\\"));
+    if (dotI == String::npos || (slashI != String::npos && dotI < slashI)) {
+        dotI = fileName.size();
+    }
+    return fileName.substr(0, dotI) + extension;
+}
+
+void NavGraph::build(const Vector<glm::vec3> & positions, const Vector<Vector<glm::vec3>> & neighbors) {
+    clear();
+
+    UnorderedMap<uint64_t, Vector<uint32_t>> cells;
+    auto find([&](const glm::vec3 & p) -> uint32_t {
+        auto it(cells.find(gridKey(p)));
+        if (it != cells.end()) {
+            for (uint32_t node : it->second) {
+                if (std::abs(m_positions[node].y - p.y) < 0.5f) {
+                    return node;
+                }
+            }
+        }
+        return k_invalid;
+    });
+    auto add([&](const glm::vec3 & p) -> uint32_t {
+        uint32_t node(uint32_t(m_positions.size()));
+        m_positions.push_back(p);
+        cells[gridKey(p)].push_back(node);
+        return node;
+    });
+
+    // given nodes come first, so their ids follow their order
+    Vector<int> sources; // index of each node's neighbors
+    for (int i(0); i < int(positions.size()); ++i) {
+        if (find(positions[i]) == k_invalid) {
+            add(positions[i]);
+            sources.push_back(i);
+        }
+    }
+
+    int nGiven(int(m_positions.size()));
+    m_offsets.reserve(nGiven + 1);
+    m_offsets.push_back(0);
+    for (int i(0); i < nGiven; ++i) {
+        for (const glm::vec3 & p : neighbors[sources[i]]) {
+            uint32_t neighbor(find(p));
+            if (neighbor == k_invalid) {
+                neighbor = add(p);
+            }
+            m_edges.push_back(neighbor);
+        }
+        m_offsets.push_back(uint32_t(m_edges.size()));
+    }
+    // nodes only known as neighbors have none of their own
+    m_offsets.resize(m_positions.size() + 1, uint32_t(m_edges.size()));
+
+    buildInEdges();
+    buildGrid();
+}
+
+void NavGraph::clear() {
+    m_positions.clear();
+    m_offsets.clear();
+    m_edges.clear();
+    m_inOffsets.clear();
+    m_inEdges.clear();
+    m_gridMin = glm::vec2();
+    m_gridWidth = 0;
+    m_gridDepth = 0;
+    m_cellOffsets.clear();
+    m_cellNodes.clear();
+    m_sourceSize = 0;
+    m_sourceHash = 0;
+}
+
+bool NavGraph::readText(const String & fileName) {
+    std::string text;
+    std::string line;
+    Vector<glm::vec3> positions;
+    Vector<Vector<glm::vec3>> nodeNeighbors;
+
+    if (!readBytes(fileName, text)) {
+        clear();
+        return false;
+    }
+    std::istringstream myfile(text);
+
+    while (getline(myfile, line)) {
+        std::istringstream iss(line);
+        std::string token;
+        float x, y, z;
+
+        std::getline(iss, token, ',');
+        x = std::stof(token);
+
+        std::getline(iss, token, ',');
+        y = std::stof(token);
+
+        std::getline(iss, token, ',');
+        z = std::stof(token);
+
+        glm::vec3 nodePos = glm::vec3(x, y, z);
+
+        Vector<glm::vec3> neighbors = Vector<glm::vec3>();
+
+        while (std::getline(iss, token, ',')) {
+            size_t pos = token.find("vec3");
+            if (pos != std::string::npos) {
+
+                x = std::stof(token.substr(5, 8));
+
+                std::getline(iss, token, ',');
+                y = std::stof(token.substr(1, 8));
+
+                std::getline(iss, token, ',');
+                z = std::stof(token.substr(1, 8));
+
+                neighbors.push_back(glm::vec3(x, y, z));
+
+            }
+        }
+
+        positions.push_back(nodePos);
+        nodeNeighbors.push_back(std::move(neighbors));
+    }
+
+    build(positions, nodeNeighbors);
+    m_sourceSize = text.size();
+    m_sourceHash = hashBytes(text.data(), text.size());
+    return true;
+}
+
+bool NavGraph::isFromText(const String & fileName) const {
+    std::string text;
+    return readBytes(fileName, text) && text.size() == m_sourceSize && hashBytes(text.data(), text.size()) == m_sourceHash;
+}
+
+bool NavGraph::write(const String & fileName) const {
+    std::ofstream file(fileName.c_str(), std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    FileHeader header{ k_magic, k_version, uint32_t(m_positions.size()), uint32_t(m_edges.size()), m_gridWidth, m_gridDepth, m_gridMin.x, m_gridMin.y, m_sourceSize, m_sourceHash };
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    // an empty graph is just the header
+    if (!m_positions.empty()) {
+        writeArray(file, m_positions);
+        writeArray(file, m_offsets);
+        writeArray(file, m_edges);
+        writeArray(file, m_inOffsets);
+        writeArray(file, m_inEdges);
+        writeArray(file, m_cellOffsets);
+        writeArray(file, m_cellNodes);
+    }
+    return bool(file);
+}
+
+bool NavGraph::read(const String & fileName) {
+    clear();
+    std::ifstream file(fileName.c_str(), std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    size_t size(size_t(file.tellg()));
+    file.seekg(0);
+    Vector<char> bytes(size);
+    if (size < sizeof(FileHeader) || !file.read(bytes.data(), std::streamsize(size))) {
+        return false;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (header.magic != k_magic || header.version != k_version || header.gridWidth < 0 || header.gridDepth < 0) {
+        return false;
+    }
+    size_t nNodes(header.nNodes), nEdges(header.nEdges), nCells(size_t(header.gridWidth) * size_t(header.gridDepth));
+    m_sourceSize = header.sourceSize;
+    m_sourceHash = header.sourceHash;
+    if (!nNodes) {
+        if (size != sizeof(header)) {
+            clear();
+            return false;
+        }
+        return true;
+    }
+    size_t expected(sizeof(header) + nNodes * sizeof(glm::vec3) + (2 * (nNodes + 1) + 2 * nEdges + (nCells + 1) + nNodes) * sizeof(uint32_t));
+    if (size != expected) {
+        clear();
+        return false;
+    }
+
+    const char * it(bytes.data() + sizeof(header));
+    readArray(it, nNodes, m_positions);
+    readArray(it, nNodes + 1, m_offsets);
+    readArray(it, nEdges, m_edges);
+    readArray(it, nNodes + 1, m_inOffsets);
+    readArray(it, nEdges, m_inEdges);
+    readArray(it, nCells + 1, m_cellOffsets);
+    readArray(it, nNodes, m_cellNodes);
+    m_gridMin = glm::vec2(header.gridMinX, header.gridMinZ);
+    m_gridWidth = header.gridWidth;
+    m_gridDepth = header.gridDepth;
+
+    // everything is indexed without checks, so it has to be sound
+    bool isValid(m_offsets.back() == nEdges && m_inOffsets.back() == nEdges && m_cellOffsets.back() == nNodes && nCells);
+    for (size_t i(0); isValid && i < nNodes; ++i) {
+        isValid = m_offsets[i] <= m_offsets[i + 1] && m_inOffsets[i] <= m_inOffsets[i + 1];
+    }
+    for (size_t i(0); isValid && i < nCells; ++i) {
+        isValid = m_cellOffsets[i] <= m_cellOffsets[i + 1];
+    }
+    for (size_t i(0); isValid && i < nEdges; ++i) {
+        isValid = m_edges[i] < nNodes && m_inEdges[i] < nNodes;
+    }
+    for (size_t i(0); isValid && i < nNodes; ++i) {
+        isValid = m_cellNodes[i] < nNodes;
+    }
+    if (!isValid) {
+        clear();
+    }
+    return isValid;
+}
+
+uint64_t NavGraph::hash() const {
+    uint64_t h(hashBytes(m_positions.data(), m_positions.size() * sizeof(glm::vec3)));
+    h = hashBytes(m_offsets.data(), m_offsets.size() * sizeof(uint32_t), h);
+    return hashBytes(m_edges.data(), m_edges.size() * sizeof(uint32_t), h);
+}
+
+uint32_t NavGraph::nearest(const glm::vec3 & pos, float maxDY) const {
+    uint32_t best(k_invalid);
+    float bestDist2(std::numeric_limits<float>::infinity());
+    if (m_positions.empty()) {
+        return best;
+    }
+
+    // positions off the grid start from the nearest cell on it
+    int cx(glm::clamp(int(std::floor((pos.x - m_gridMin.x) / k_cellSize)), 0, m_gridWidth - 1));
+    int cz(glm::clamp(int(std::floor((pos.z - m_gridMin.y) / k_cellSize)), 0, m_gridDepth - 1));
+    int maxR(std::max(std::max(cx, m_gridWidth - 1 - cx), std::max(cz, m_gridDepth - 1 - cz)));
+    for (int r(0); r <= maxR; ++r) {
+        // anything in ring r is at least r - 1 cells away horizontally
+        float minDist(float(r - 1) * k_cellSize);
+        if (r > 0 && minDist * minDist >= bestDist2) {
+            break;
+        }
+        int x0(cx - r), x1(cx + r), z0(cz - r), z1(cz + r);
+        for (int x(std::max(x0, 0)); x <= std::min(x1, m_gridWidth - 1); ++x) {
+            if (z0 >= 0) nearestInCell(x, z0, pos, maxDY, best, bestDist2);
+            if (z1 < m_gridDepth && r > 0) nearestInCell(x, z1, pos, maxDY, best, bestDist2);
+        }
+        for (int z(std::max(z0 + 1, 0)); z <= std::min(z1 - 1, m_gridDepth - 1); ++z) {
+            if (x0 >= 0) nearestInCell(x0, z, pos, maxDY, best, bestDist2);
+            if (x1 < m_gridWidth && r > 0) nearestInCell(x1, z, pos, maxDY, best, bestDist2);
+        }
+    }
+    return best;
+}
+
+void NavGraph::buildInEdges() {
+    // counting sort of the edges by the node they lead to
+    int n(int(m_positions.size()));
+    m_inOffsets.assign(n + 1, 0);
+    for (uint32_t to : m_edges) {
+        ++m_inOffsets[to + 1];
+    }
+    for (int i(0); i < n; ++i) {
+        m_inOffsets[i + 1] += m_inOffsets[i];
+    }
+    m_inEdges.resize(m_edges.size());
+    Vector<uint32_t> fill(m_inOffsets.begin(), m_inOffsets.end() - 1);
+    for (int from(0); from < n; ++from) {
+        for (uint32_t i(m_offsets[from]); i < m_offsets[from + 1]; ++i) {
+            m_inEdges[fill[m_edges[i]]++] = uint32_t(from);
+        }
+    }
+}
+
+void NavGraph::buildGrid() {
+    if (m_positions.empty()) {
+        return;
+    }
+
+    glm::vec2 min(m_positions.front().x, m_positions.front().z), max(min);
+    for (const glm::vec3 & p : m_positions) {
+        min = glm::min(min, glm::vec2(p.x, p.z));
+        max = glm::max(max, glm::vec2(p.x, p.z));
+    }
+    m_gridMin = min;
+    m_gridWidth = int((max.x - min.x) / k_cellSize) + 1;
+    m_gridDepth = int((max.y - min.y) / k_cellSize) + 1;
+
+    // counting sort of the nodes by cell
+    Vector<uint32_t> cells(m_positions.size());
+    m_cellOffsets.assign(m_gridWidth * m_gridDepth + 1, 0);
+    for (int i(0); i < int(m_positions.size()); ++i) {
+        int cx(glm::clamp(int((m_positions[i].x - min.x) / k_cellSize), 0, m_gridWidth - 1));
+        int cz(glm::clamp(int((m_positions[i].z - min.y) / k_cellSize), 0, m_gridDepth - 1));
+        cells[i] = uint32_t(cz * m_gridWidth + cx);
+        ++m_cellOffsets[cells[i] + 1];
+    }
+    for (int c(0); c < m_gridWidth * m_gridDepth; ++c) {
+        m_cellOffsets[c + 1] += m_cellOffsets[c];
+    }
+    m_cellNodes.resize(m_positions.size());
+    Vector<uint32_t> fill(m_cellOffsets.begin(), m_cellOffsets.end() - 1);
+    for (int i(0); i < int(m_positions.size()); ++i) {
+        m_cellNodes[fill[cells[i]]++] = uint32_t(i);
+    }
+}
+
+void NavGraph::nearestInCell(int cx, int cz, const glm::vec3 & pos, float maxDY, uint32_t & r_best, float & r_bestDist2) const {
+    int c(cz * m_gridWidth + cx);
+    for (uint32_t i(m_cellOffsets[c]); i < m_cellOffsets[c + 1]; ++i) {
+        uint32_t node(m_cellNodes[i]);
+        const glm::vec3 & p(m_positions[node]);
+        if (std::abs(pos.y - p.y) >= maxDY) {
+            continue;
+        }
+        glm::vec3 d(p - pos);
+        float dist2(glm::dot(d, d));
+        if (dist2 < r_bestDist2 || (dist2 == r_bestDist2 && node < r_best)) {
+            r_best = node;
+            r_bestDist2 = dist2;
+        }
+    }
+}
+
+
+
+void NavField::build(const NavGraph & graph, uint32_t target, uint32_t maxDistance) {
+    m_target = target;
+    m_distances.assign(graph.nNodes(), k_unreached);
+    m_queue.clear();
+    if (target == NavGraph::k_invalid) {
+        return;
+    }
+
+    m_distances[target] = 0;
+    m_queue.push_back(target);
+    for (int i(0); i < int(m_queue.size()); ++i) {
+        uint32_t node(m_queue[i]);
+        if (m_distances[node] >= maxDistance) {
+            continue;
+        }
+        uint32_t distance(m_distances[node] + 1);
+        for (const uint32_t * it(graph.inNeighborsBegin(node)); it != graph.inNeighborsEnd(node); ++it) {
+            if (m_distances[*it] == k_unreached) {
+                m_distances[*it] = distance;
+                m_queue.push_back(*it);
+            }
+        }
+    }
+}
+
+uint32_t NavField::next(const NavGraph & graph, uint32_t node) const {
+    if (node == NavGraph::k_invalid || node >= uint32_t(m_distances.size())) {
+        return NavGraph::k_invalid;
+    }
+    uint32_t distance(m_distances[node]);
+    if (distance == 0 || distance == k_unreached) {
+        return NavGraph::k_invalid;
+    }
+    for (const uint32_t * it(graph.neighborsBegin(node)); it != graph.neighborsEnd(node); ++it) {
+        if (m_distances[*it] < distance) {
+            return *it;
+        }
+    }
+    return NavGraph::k_invalid;
+}
+
+
+
+bool NavSearch::findPath(const NavGraph & graph, uint32_t start, uint32_t goal, Vector<uint32_t> & r_path) {
+    r_path.clear();
+    m_nVisited = 0;
+    if (start == NavGraph::k_invalid || goal == NavGraph::k_invalid) {
+        return false;
+    }
+
+    reset(graph.nNodes());
+    const glm::vec3 & goalPos(graph.position(goal));
+    // makes the heap a min heap
+    auto heapCompare([](const OpenNode & a, const OpenNode & b) { return a.priority > b.priority; });
+
+    m_stamps[start] = m_stamp;
+    m_costs[start] = 0.0f;
+    m_cameFrom[start] = start;
+    m_open.push_back(OpenNode{ manhattan(graph.position(start), goalPos), start });
+
+    while (!m_open.empty()) {
+        std::pop_heap(m_open.begin(), m_open.end(), heapCompare);
+        uint32_t current(m_open.back().node);
+        m_open.pop_back();
+
+        // already expanded at its best cost
+        if (isClosed(current)) {
+            continue;
+        }
+        ++m_nVisited;
+
+        if (current == goal) {
+            for (uint32_t node(goal); ; node = m_cameFrom[node]) {
+                r_path.push_back(node);
+                if (node == start) break;
+            }
+            std::reverse(r_path.begin(), r_path.end());
+            return true;
+        }
+
+        setClosed(current, true);
+        float cost(m_costs[current] + 1.0f);
+        for (const uint32_t * it(graph.neighborsBegin(current)); it != graph.neighborsEnd(current); ++it) {
+            uint32_t next(*it);
+            if (m_stamps[next] != m_stamp || cost < m_costs[next]) {
+                m_stamps[next] = m_stamp;
+                m_costs[next] = cost;
+                m_cameFrom[next] = current;
+                // the heuristic isn't consistent, so a cheaper way to an
+                // expanded node means expanding it again
+                setClosed(next, false);
+                m_open.push_back(OpenNode{ cost + manhattan(graph.position(next), goalPos), next });
+                std::push_heap(m_open.begin(), m_open.end(), heapCompare);
+            }
+        }
+    }
+
+    return false;
+}
+
+void NavSearch::reset(int nNodes) {
+    if (int(m_stamps.size()) != nNodes) {
+        m_costs.assign(nNodes, 0.0f);
+        m_cameFrom.assign(nNodes, NavGraph::k_invalid);
+        m_stamps.assign(nNodes, 0);
+        m_stamp = 0;
+    }
+    // on wrapping, old stamps could be mistaken for this search's
+    if (++m_stamp == 0) {
+        std::fill(m_stamps.begin(), m_stamps.end(), 0);
+        m_stamp = 1;
+    }
+    m_closed.assign((nNodes + 63) / 64, 0);
+    m_open.clear();
+}
+
+void NavSearch::setClosed(uint32_t node, bool closed) {
+    if (closed) {
+        m_closed[node >> 6] |= uint64_t(1) << (node & 63);
+    }
+    else {
+        m_closed[node >> 6] &= ~(uint64_t(1) << (node & 63));
+    }
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+
+
+#include <cstdint>
+
+#include "glm/glm.hpp"
+
+#include "Memory.hpp"
+
+
+
+// A navigation graph whose nodes are dense ids. Positions are kept in an array
+// parallel to the ids, and edges are stored compressed, as one array of every
+// node's neighbors where each node's run is given by an array of offsets. The
+// same is kept of the edges reversed, so searches can run back from a target.
+// Nodes are also bucketed in a uniform grid over x and z for nearest queries
+class NavGraph {
+
+    // precedes the arrays in the binary format
+    struct FileHeader {
+
+        uint32_t magic, version;
+        uint32_t nNodes, nEdges;
+        int32_t gridWidth, gridDepth;
+        float gridMinX, gridMinZ;
+        uint64_t sourceSize, sourceHash;
+
+    };
+
+    public:
+
+    static constexpr uint32_t k_invalid = UINT32_MAX;
+    static constexpr float k_cellSize = 4.0f;
+    static constexpr uint32_t k_magic = 0x4756414E; // "NAVG"
+    static constexpr uint32_t k_version = 2;
+
+    NavGraph() = default;
+
+    // fileName with its extension, if any, replaced by extension, which is
+    // how the files kept alongside a graph are named
+    static String withExtension(const String & fileName, const char * extension);
+
+    // Replaces any previous contents. Neighbors are given by position and
+    // matched to nodes on the grid, where a node matches if it rounds to the
+    // same x and z and is within half a unit in y. A neighbor that matches no
+    // node becomes a node of its own with no neighbors. Where two nodes would
+    // match each other, the first is kept
+    void build(const Vector<glm::vec3> & positions, const Vector<Vector<glm::vec3>> & neighbors);
+
+    void clear();
+
+    // Builds from the text format MapExploreComponent writes, where each line
+    // is a position followed by its neighbors'. Returns false if the file
+    // couldn't be opened
+    bool readText(const String & fileName);
+
+    // Whether this was read from the text in fileName, as it is now, by
+    // the file's size and hash. False if the file couldn't be opened
+    bool isFromText(const String & fileName) const;
+
+    // Versioned binary, holding everything that's built, so that reading it
+    // back is a single read and some copies. The size and hash of the text
+    // it was read from are kept too. Returns false on failure
+    bool write(const String & fileName) const;
+
+    // Returns false on failure, including a file of another version, and
+    // leaves this empty
+    bool read(const String & fileName);
+
+    bool empty() const { return m_positions.empty(); }
+
+    int nNodes() const { return int(m_positions.size()); }
+    int nEdges() const { return int(m_edges.size()); }
+
+    // Of the positions and edges, so anything made from a graph can tell
+    // whether it still matches it
+    uint64_t hash() const;
+
+    const glm::vec3 & position(uint32_t node) const { return m_positions[node]; }
+
+    // the neighbors of node are [neighborsBegin, neighborsEnd)
+    const uint32_t * neighborsBegin(uint32_t node) const { return m_edges.data() + m_offsets[node]; }
+    const uint32_t * neighborsEnd(uint32_t node) const { return m_edges.data() + m_offsets[node + 1]; }
+
+    // the nodes that have node as a neighbor are [inNeighborsBegin, inNeighborsEnd)
+    const uint32_t * inNeighborsBegin(uint32_t node) const { return m_inEdges.data() + m_inOffsets[node]; }
+    const uint32_t * inNeighborsEnd(uint32_t node) const { return m_inEdges.data() + m_inOffsets[node + 1]; }
+
+    // The node nearest to pos that is less than maxDY above or below it, or
+    // k_invalid if there is none. Searches outward from pos's cell a ring of
+    // cells at a time, until no unsearched cell could hold anything nearer
+    uint32_t nearest(const glm::vec3 & pos, float maxDY) const;
+
+    private:
+
+    void buildInEdges();
+    void buildGrid();
+
+    // the nearest allowed node in the cell, if nearer than r_best
+    void nearestInCell(int cx, int cz, const glm::vec3 & pos, float maxDY, uint32_t & r_best, float & r_bestDist2) const;
+
+    Vector<glm::vec3> m_positions;
+    Vector<uint32_t> m_offsets; // one more than there are nodes
+    Vector<uint32_t> m_edges;
+    Vector<uint32_t> m_inOffsets; // one more than there are nodes
+    Vector<uint32_t> m_inEdges;
+
+    glm::vec2 m_gridMin; // x and z
+    int m_gridWidth = 0; // cells along x
+    int m_gridDepth = 0; // cells along z
+    Vector<uint32_t> m_cellOffsets; // one more than there are cells
+    Vector<uint32_t> m_cellNodes; // node ids, grouped by cell
+
+    uint64_t m_sourceSize = 0; // of the text read from, if any
+    uint64_t m_sourceHash = 0;
+
+};
+
+
+
+// Every node's distance in edges to a target node, found by a breadth first
+// search back from the target, out to some distance. Stepping to whichever
+// neighbor is nearest leads any reached node to the target, so one field
+// serves everything heading there
+class NavField {
+
+    public:
+
+    static constexpr uint32_t k_unreached = UINT32_MAX;
+
+    NavField() = default;
+
+    // Replaces any previous contents. Nodes further than maxDistance are left
+    // unreached. Reuses its memory
+    void build(const NavGraph & graph, uint32_t target, uint32_t maxDistance = k_unreached);
+
+    uint32_t target() const { return m_target; }
+
+    uint32_t distance(uint32_t node) const { return m_distances[node]; }
+
+    // The neighbor of node that is a step nearer the target, or
+    // NavGraph::k_invalid if node is the target or can't reach it
+    uint32_t next(const NavGraph & graph, uint32_t node) const;
+
+    private:
+
+    uint32_t m_target = NavGraph::k_invalid;
+    Vector<uint32_t> m_distances;
+    Vector<uint32_t> m_queue;
+
+};
+
+
+
+// Scratch space for searching a nav graph, kept between searches so that they
+// don't allocate once it has grown to the graph's size
+class NavSearch {
+
+    struct OpenNode {
+
+        float priority;
+        uint32_t node;
+
+    };
+
+    public:
+
+    NavSearch() = default;
+
+    // A* from start to goal, where every edge costs 1. On success r_path is
+    // the nodes from start to goal inclusive
+    bool findPath(const NavGraph & graph, uint32_t start, uint32_t goal, Vector<uint32_t> & r_path);
+
+    // the number of nodes the last search expanded
+    int nVisited() const { return m_nVisited; }
+
+    private:
+
+    void reset(int nNodes);
+
+    bool isClosed(uint32_t node) const { return (m_closed[node >> 6] >> (node & 63)) & 1; }
+    void setClosed(uint32_t node, bool closed);
+
+    Vector<float> m_costs;
+    Vector<uint32_t> m_cameFrom;
+    Vector<uint32_t> m_stamps; // a node's cost and cameFrom are only set this search if its stamp is m_stamp
+    uint32_t m_stamp = 0;
+    Vector<uint64_t> m_closed; // bit per node
+    Vector<OpenNode> m_open; // binary min heap
+    int m_nVisited = 0;
+
+};
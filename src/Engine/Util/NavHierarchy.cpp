@@ -0,0 +1,502 @@
+#include "NavHierarchy.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+
+
+namespace {
+
+float manhattan(const glm::vec3 & a, const glm::vec3 & b) {
+    return std::abs(a.x - b.x) + std::abs(a.y - b.y) + std::abs(a.z - b.z);
+}
+
+template <typename T>
+void writeArray(std::ofstream & file, const Vector<T> & v) {
+    uint32_t n(uint32_t(v.size()));
+    file.write(reinterpret_cast<const char *>(&n), sizeof(n));
+    file.write(reinterpret_cast<const char *>(v.data()), std::streamsize(n * sizeof(T)));
+}
+
+template <typename T>
+bool readArray(std::ifstream & file, Vector<T> & r_v) {
+    uint32_t n(0);
+    if (!file.read(reinterpret_cast<char *>(&n), sizeof(n))) {
+        return false;
+    }
+    r_v.resize(n);
+    return bool(file.read(reinterpret_cast<char *>(r_v.data()), std::streamsize(n * sizeof(T))));
+}
+
+}
+
+
+
+constexpr float NavHierarchy::k_zoneSize;
+constexpr float NavHierarchy::k_zoneHeight;
+constexpr int NavHierarchy::k_maxEntranceWidth;
+constexpr uint32_t NavHierarchy::k_magic;
+constexpr uint32_t NavHierarchy::k_version;
+
+void NavHierarchy::build(const NavGraph & graph) {
+    clear();
+    int n(graph.nNodes());
+    m_graphHash = graph.hash();
+    if (!n) {
+        return;
+    }
+
+    // each node's block and band, packed together
+    glm::vec3 min(graph.position(0));
+    for (int i(1); i < n; ++i) {
+        const glm::vec3 & p(graph.position(i));
+        min.x = std::min(min.x, p.x);
+        min.y = std::min(min.y, p.y);
+        min.z = std::min(min.z, p.z);
+    }
+    Vector<uint64_t> keys(n);
+    for (int i(0); i < n; ++i) {
+        const glm::vec3 & p(graph.position(i));
+        uint64_t kx(uint64_t((p.x - min.x) / k_zoneSize) & 0x1FFFFF);
+        uint64_t ky(uint64_t((p.y - min.y) / k_zoneHeight) & 0x1FFFFF);
+        uint64_t kz(uint64_t((p.z - min.z) / k_zoneSize) & 0x1FFFFF);
+        keys[i] = (kx << 42) | (kz << 21) | ky;
+    }
+
+    // a zone is whatever is connected, either way, within a block and band
+    m_zones.assign(n, NavGraph::k_invalid);
+    uint32_t nZones(0);
+    Vector<uint32_t> queue;
+    for (int seed(0); seed < n; ++seed) {
+        if (m_zones[seed] != NavGraph::k_invalid) {
+            continue;
+        }
+        uint32_t zone(nZones++);
+        m_zones[seed] = zone;
+        queue.clear();
+        queue.push_back(uint32_t(seed));
+        auto visit([&](uint32_t node, uint32_t neighbor) {
+            if (m_zones[neighbor] == NavGraph::k_invalid && keys[neighbor] == keys[node]) {
+                m_zones[neighbor] = zone;
+                queue.push_back(neighbor);
+            }
+        });
+        for (int i(0); i < int(queue.size()); ++i) {
+            uint32_t node(queue[i]);
+            for (const uint32_t * it(graph.neighborsBegin(node)); it != graph.neighborsEnd(node); ++it) visit(node, *it);
+            for (const uint32_t * it(graph.inNeighborsBegin(node)); it != graph.inNeighborsEnd(node); ++it) visit(node, *it);
+        }
+    }
+
+    // every edge from one zone to another, grouped by the pair of zones and
+    // ordered along the border between them
+    struct Crossing {
+
+        uint32_t fromZone, toZone;
+        uint32_t from, to;
+
+    };
+    Vector<Crossing> crossings;
+    for (int from(0); from < n; ++from) {
+        for (const uint32_t * it(graph.neighborsBegin(from)); it != graph.neighborsEnd(from); ++it) {
+            if (m_zones[from] != m_zones[*it]) {
+                crossings.push_back(Crossing{ m_zones[from], m_zones[*it], uint32_t(from), *it });
+            }
+        }
+    }
+    std::sort(crossings.begin(), crossings.end(), [&](const Crossing & a, const Crossing & b) {
+        if (a.fromZone != b.fromZone) return a.fromZone < b.fromZone;
+        if (a.toZone != b.toZone) return a.toZone < b.toZone;
+        const glm::vec3 & pa(graph.position(a.from)), & pb(graph.position(b.from));
+        if (pa.x != pb.x) return pa.x < pb.x;
+        if (pa.z != pb.z) return pa.z < pb.z;
+        return a.to < b.to;
+    });
+    auto isTwoWay([&](const Crossing & crossing) {
+        return std::find(graph.neighborsBegin(crossing.to), graph.neighborsEnd(crossing.to), crossing.from) != graph.neighborsEnd(crossing.to);
+    });
+
+    // a border is split into entrances wherever it breaks, and into pieces
+    // no wider than k_maxEntranceWidth, and each entrance's middle crossing
+    // is its portal. One that can be crossed back is preferred, as the other
+    // side of a one way crossing may lead nowhere
+    m_portalIs.assign(n, NavGraph::k_invalid);
+    auto portal([&](uint32_t node) {
+        if (m_portalIs[node] == NavGraph::k_invalid) {
+            m_portalIs[node] = uint32_t(m_portals.size());
+            m_portals.push_back(node);
+        }
+        return m_portalIs[node];
+    });
+    Vector<Vector<Edge>> edges;
+    Vector<Vector<uint32_t>> paths; // of each edge, grouped by portal
+    for (int i(0), j(0); i < int(crossings.size()); i = j) {
+        for (j = i + 1; j < int(crossings.size()); ++j) {
+            const Crossing & prev(crossings[j - 1]), & crossing(crossings[j]);
+            glm::vec3 d(graph.position(crossing.from) - graph.position(prev.from));
+            if (crossing.fromZone != prev.fromZone || crossing.toZone != prev.toZone || j - i >= k_maxEntranceWidth || glm::dot(d, d) > 2.0f) {
+                break;
+            }
+        }
+        glm::vec3 middle(0.0f);
+        for (int k(i); k < j; ++k) {
+            middle += graph.position(crossings[k].from);
+        }
+        middle /= float(j - i);
+        int best(i);
+        bool bestTwoWay(false);
+        float bestDist2(std::numeric_limits<float>::infinity());
+        for (int k(i); k < j; ++k) {
+            glm::vec3 d(graph.position(crossings[k].from) - middle);
+            float dist2(glm::dot(d, d));
+            bool twoWay(isTwoWay(crossings[k]));
+            if ((twoWay && !bestTwoWay) || (twoWay == bestTwoWay && dist2 < bestDist2)) {
+                best = k;
+                bestTwoWay = twoWay;
+                bestDist2 = dist2;
+            }
+        }
+        portal(crossings[best].from);
+        portal(crossings[best].to);
+    }
+
+    // any crossing between two portals is kept, not just those chosen, as
+    // a portal may be the only way into part of its zone
+    edges.resize(m_portals.size());
+    paths.resize(m_portals.size());
+    for (const Crossing & crossing : crossings) {
+        uint32_t from(m_portalIs[crossing.from]), to(m_portalIs[crossing.to]);
+        if (from != NavGraph::k_invalid && to != NavGraph::k_invalid && (edges[from].empty() || edges[from].back().to != to)) {
+            edges[from].push_back(Edge{ to, 1 });
+            paths[from].push_back(crossing.to);
+        }
+    }
+    buildLookups();
+
+    // portals in the same zone are joined by the way between them within it
+    Vector<uint32_t> path;
+    for (uint32_t zone(0); zone < nZones; ++zone) {
+        for (uint32_t i(m_zonePortalOffsets[zone]); i < m_zonePortalOffsets[zone + 1]; ++i) {
+            uint32_t from(m_zonePortals[i]);
+            searchZone(graph, m_portals[from], NavGraph::k_invalid, false);
+            for (uint32_t j(m_zonePortalOffsets[zone]); j < m_zonePortalOffsets[zone + 1]; ++j) {
+                uint32_t to(m_zonePortals[j]);
+                if (to != from && isZoneReached(m_portals[to])) {
+                    edges[from].push_back(Edge{ to, m_zoneDists[m_portals[to]] });
+                    path.clear();
+                    appendZonePath(m_portals[from], m_portals[to], path);
+                    paths[from].insert(paths[from].end(), path.begin(), path.end());
+                }
+            }
+        }
+    }
+
+    // each edge's path is the nodes after its portal, up to and including
+    // the one it leads to, so its length is its cost
+    m_offsets.reserve(m_portals.size() + 1);
+    m_offsets.push_back(0);
+    m_pathOffsets.push_back(0);
+    for (int i(0); i < int(m_portals.size()); ++i) {
+        m_edges.insert(m_edges.end(), edges[i].begin(), edges[i].end());
+        m_offsets.push_back(uint32_t(m_edges.size()));
+        m_pathNodes.insert(m_pathNodes.end(), paths[i].begin(), paths[i].end());
+        for (const Edge & edge : edges[i]) {
+            m_pathOffsets.push_back(m_pathOffsets.back() + edge.cost);
+        }
+    }
+}
+
+void NavHierarchy::clear() {
+    m_zones.clear();
+    m_portals.clear();
+    m_offsets.clear();
+    m_edges.clear();
+    m_pathOffsets.clear();
+    m_pathNodes.clear();
+    m_graphHash = 0;
+    m_portalIs.clear();
+    m_zonePortalOffsets.clear();
+    m_zonePortals.clear();
+}
+
+bool NavHierarchy::matches(const NavGraph & graph) const {
+    return int(m_zones.size()) == graph.nNodes() && m_graphHash == graph.hash();
+}
+
+bool NavHierarchy::findPath(const NavGraph & graph, uint32_t start, uint32_t goal, Vector<uint32_t> & r_path) {
+    r_path.clear();
+    m_nVisited = 0;
+    if (start == NavGraph::k_invalid || goal == NavGraph::k_invalid) {
+        return false;
+    }
+
+    // nearby goals are found without the portals
+    if (m_zones[start] == m_zones[goal] && searchZone(graph, start, goal, false)) {
+        r_path.push_back(start);
+        appendZonePath(start, goal, r_path);
+        return true;
+    }
+
+    if (!findAbstractPath(graph, start, goal)) {
+        return false;
+    }
+
+    // legs between portals were kept, and the first and last are found
+    uint32_t startI(uint32_t(m_portals.size())), goalI(startI + 1);
+    r_path.push_back(start);
+    for (int i(1); i < int(m_abstractPath.size()); ++i) {
+        uint32_t from(m_abstractPath[i - 1]), to(m_abstractPath[i]);
+        if (from == startI || to == goalI) {
+            uint32_t fromNode(from == startI ? start : m_portals[from]), toNode(to == goalI ? goal : m_portals[to]);
+            if (!searchZone(graph, fromNode, toNode, false)) {
+                r_path.clear();
+                return false;
+            }
+            appendZonePath(fromNode, toNode, r_path);
+        }
+        else {
+            uint32_t edge(findEdge(from, to));
+            r_path.insert(r_path.end(), m_pathNodes.begin() + m_pathOffsets[edge], m_pathNodes.begin() + m_pathOffsets[edge + 1]);
+        }
+    }
+    return true;
+}
+
+bool NavHierarchy::write(const String & fileName) const {
+    std::ofstream file(fileName.c_str(), std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    FileHeader header{ k_magic, k_version, m_graphHash };
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    writeArray(file, m_zones);
+    writeArray(file, m_portals);
+    writeArray(file, m_offsets);
+    writeArray(file, m_edges);
+    writeArray(file, m_pathOffsets);
+    writeArray(file, m_pathNodes);
+    return bool(file);
+}
+
+bool NavHierarchy::read(const String & fileName) {
+    clear();
+    std::ifstream file(fileName.c_str(), std::ios::binary);
+    FileHeader header{};
+    if (!file || !file.read(reinterpret_cast<char *>(&header), sizeof(header)) || header.magic != k_magic || header.version != k_version) {
+        return false;
+    }
+    m_graphHash = header.graphHash;
+    bool isValid(
+        readArray(file, m_zones) && readArray(file, m_portals) && readArray(file, m_offsets) && readArray(file, m_edges) &&
+        readArray(file, m_pathOffsets) && readArray(file, m_pathNodes) &&
+        m_offsets.size() == m_portals.size() + 1 && m_offsets.front() == 0 && m_offsets.back() == m_edges.size() &&
+        m_pathOffsets.size() == m_edges.size() + 1 && m_pathOffsets.front() == 0 && m_pathOffsets.back() == m_pathNodes.size()
+    );
+
+    // everything is indexed without checks, so it has to be sound
+    size_t nNodes(m_zones.size()), nPortals(m_portals.size()), nEdges(m_edges.size());
+    for (size_t i(0); isValid && i < nNodes; ++i) {
+        isValid = m_zones[i] < nNodes;
+    }
+    for (size_t i(0); isValid && i < nPortals; ++i) {
+        isValid = m_portals[i] < nNodes && m_offsets[i] <= m_offsets[i + 1];
+    }
+    for (size_t i(0); isValid && i < nEdges; ++i) {
+        // each edge's path is as long as it costs
+        isValid = m_edges[i].to < nPortals && m_pathOffsets[i] <= m_pathOffsets[i + 1] && m_pathOffsets[i + 1] - m_pathOffsets[i] == m_edges[i].cost;
+    }
+    for (size_t i(0); isValid && i < m_pathNodes.size(); ++i) {
+        isValid = m_pathNodes[i] < nNodes;
+    }
+    if (!isValid) {
+        clear();
+        return false;
+    }
+    buildLookups();
+    return true;
+}
+
+void NavHierarchy::buildLookups() {
+    m_portalIs.assign(m_zones.size(), NavGraph::k_invalid);
+    for (uint32_t i(0); i < uint32_t(m_portals.size()); ++i) {
+        m_portalIs[m_portals[i]] = i;
+    }
+
+    // counting sort of the portals by zone
+    uint32_t nZones(0);
+    for (uint32_t zone : m_zones) {
+        nZones = std::max(nZones, zone + 1);
+    }
+    m_zonePortalOffsets.assign(nZones + 1, 0);
+    for (uint32_t node : m_portals) {
+        ++m_zonePortalOffsets[m_zones[node] + 1];
+    }
+    for (uint32_t zone(0); zone < nZones; ++zone) {
+        m_zonePortalOffsets[zone + 1] += m_zonePortalOffsets[zone];
+    }
+    m_zonePortals.resize(m_portals.size());
+    Vector<uint32_t> fill(m_zonePortalOffsets.begin(), m_zonePortalOffsets.end() - 1);
+    for (uint32_t i(0); i < uint32_t(m_portals.size()); ++i) {
+        m_zonePortals[fill[m_zones[m_portals[i]]]++] = i;
+    }
+}
+
+bool NavHierarchy::searchZone(const NavGraph & graph, uint32_t from, uint32_t target, bool isReverse) {
+    if (int(m_zoneStamps.size()) != graph.nNodes()) {
+        m_zoneDists.assign(graph.nNodes(), 0);
+        m_zoneCameFrom.assign(graph.nNodes(), NavGraph::k_invalid);
+        m_zoneStamps.assign(graph.nNodes(), 0);
+        m_zoneStamp = 0;
+    }
+    // on wrapping, old stamps could be mistaken for this search's
+    if (++m_zoneStamp == 0) {
+        std::fill(m_zoneStamps.begin(), m_zoneStamps.end(), 0);
+        m_zoneStamp = 1;
+    }
+
+    uint32_t zone(m_zones[from]);
+    m_zoneStamps[from] = m_zoneStamp;
+    m_zoneDists[from] = 0;
+    m_zoneCameFrom[from] = from;
+    m_zoneQueue.clear();
+    m_zoneQueue.push_back(from);
+    for (int i(0); i < int(m_zoneQueue.size()); ++i) {
+        uint32_t node(m_zoneQueue[i]);
+        ++m_nVisited;
+        if (node == target) {
+            return true;
+        }
+        uint32_t dist(m_zoneDists[node] + 1);
+        const uint32_t * begin(isReverse ? graph.inNeighborsBegin(node) : graph.neighborsBegin(node));
+        const uint32_t * end(isReverse ? graph.inNeighborsEnd(node) : graph.neighborsEnd(node));
+        for (const uint32_t * it(begin); it != end; ++it) {
+            if (m_zones[*it] == zone && m_zoneStamps[*it] != m_zoneStamp) {
+                m_zoneStamps[*it] = m_zoneStamp;
+                m_zoneDists[*it] = dist;
+                m_zoneCameFrom[*it] = node;
+                m_zoneQueue.push_back(*it);
+            }
+        }
+    }
+    return false;
+}
+
+void NavHierarchy::appendZonePath(uint32_t from, uint32_t target, Vector<uint32_t> & r_path) {
+    int begin(int(r_path.size()));
+    for (uint32_t node(target); node != from; node = m_zoneCameFrom[node]) {
+        r_path.push_back(node);
+    }
+    std::reverse(r_path.begin() + begin, r_path.end());
+}
+
+bool NavHierarchy::findAbstractPath(const NavGraph & graph, uint32_t start, uint32_t goal) {
+    m_abstractPath.clear();
+
+    // start and goal join the portals of their zones for this search only
+    uint32_t startZone(m_zones[start]), goalZone(m_zones[goal]);
+    m_startEdges.clear();
+    searchZone(graph, start, NavGraph::k_invalid, false);
+    for (uint32_t i(m_zonePortalOffsets[startZone]); i < m_zonePortalOffsets[startZone + 1]; ++i) {
+        uint32_t portal(m_zonePortals[i]);
+        if (isZoneReached(m_portals[portal])) {
+            m_startEdges.push_back(Edge{ portal, m_zoneDists[m_portals[portal]] });
+        }
+    }
+    m_goalEdges.clear();
+    searchZone(graph, goal, NavGraph::k_invalid, true);
+    for (uint32_t i(m_zonePortalOffsets[goalZone]); i < m_zonePortalOffsets[goalZone + 1]; ++i) {
+        uint32_t portal(m_zonePortals[i]);
+        if (isZoneReached(m_portals[portal])) {
+            m_goalEdges.push_back(Edge{ portal, m_zoneDists[m_portals[portal]] });
+        }
+    }
+    if (m_startEdges.empty() || m_goalEdges.empty()) {
+        return false;
+    }
+
+    uint32_t startI(uint32_t(m_portals.size())), goalI(startI + 1);
+    auto node([&](uint32_t i) { return i < startI ? m_portals[i] : i == startI ? start : goal; });
+    const glm::vec3 & goalPos(graph.position(goal));
+    auto heuristic([&](uint32_t i) { return manhattan(graph.position(node(i)), goalPos); });
+
+    int n(int(m_portals.size()) + 2);
+    if (int(m_stamps.size()) != n) {
+        m_costs.assign(n, 0.0f);
+        m_cameFrom.assign(n, NavGraph::k_invalid);
+        m_stamps.assign(n, 0);
+        m_stamp = 0;
+    }
+    if (++m_stamp == 0) {
+        std::fill(m_stamps.begin(), m_stamps.end(), 0);
+        m_stamp = 1;
+    }
+    m_open.clear();
+    // makes the heap a min heap
+    auto heapCompare([](const OpenNode & a, const OpenNode & b) { return a.priority > b.priority; });
+    auto relax([&](uint32_t from, uint32_t to, uint32_t cost) {
+        float toCost(m_costs[from] + float(cost));
+        if (m_stamps[to] != m_stamp || toCost < m_costs[to]) {
+            m_stamps[to] = m_stamp;
+            m_costs[to] = toCost;
+            m_cameFrom[to] = from;
+            m_open.push_back(OpenNode{ toCost + heuristic(to), to });
+            std::push_heap(m_open.begin(), m_open.end(), heapCompare);
+        }
+    });
+
+    m_stamps[startI] = m_stamp;
+    m_costs[startI] = 0.0f;
+    m_cameFrom[startI] = startI;
+    m_open.push_back(OpenNode{ heuristic(startI), startI });
+
+    while (!m_open.empty()) {
+        std::pop_heap(m_open.begin(), m_open.end(), heapCompare);
+        OpenNode current(m_open.back());
+        m_open.pop_back();
+
+        // superseded by a cheaper way there
+        if (current.priority > m_costs[current.node] + heuristic(current.node)) {
+            continue;
+        }
+        ++m_nVisited;
+
+        if (current.node == goalI) {
+            for (uint32_t i(goalI); ; i = m_cameFrom[i]) {
+                m_abstractPath.push_back(i);
+                if (i == startI) break;
+            }
+            std::reverse(m_abstractPath.begin(), m_abstractPath.end());
+            return true;
+        }
+
+        if (current.node == startI) {
+            for (const Edge & edge : m_startEdges) {
+                relax(startI, edge.to, edge.cost);
+            }
+            continue;
+        }
+        for (uint32_t i(m_offsets[current.node]); i < m_offsets[current.node + 1]; ++i) {
+            relax(current.node, m_edges[i].to, m_edges[i].cost);
+        }
+        if (m_zones[m_portals[current.node]] == goalZone) {
+            for (const Edge & edge : m_goalEdges) {
+                if (edge.to == current.node) {
+                    relax(current.node, goalI, edge.cost);
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+uint32_t NavHierarchy::findEdge(uint32_t from, uint32_t to) const {
+    for (uint32_t i(m_offsets[from]); i < m_offsets[from + 1]; ++i) {
+        if (m_edges[i].to == to) {
+            return i;
+        }
+    }
+    return NavGraph::k_invalid;
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+
+
+#include <cstdint>
+
+#include "glm/glm.hpp"
+
+#include "Memory.hpp"
+#include "NavGraph.hpp"
+
+
+
+// A two level abstraction of a nav graph for long searches. Nodes are
+// clustered into zones, each a connected piece of one block of the grid on one
+// floor. Where zones meet, the middle edge of each stretch of their border is
+// made a portal, and the portals in a zone are joined by the shortest way
+// between them within it, which is kept. A search runs over the portals, so
+// only the legs from the start and to the goal are searched for node by node,
+// each confined to a single zone
+class NavHierarchy {
+
+    // precedes the arrays in the binary format
+    struct FileHeader {
+
+        uint32_t magic, version;
+        uint64_t graphHash;
+
+    };
+
+    struct Edge {
+
+        uint32_t to; // portal index
+        uint32_t cost;
+
+    };
+
+    struct OpenNode {
+
+        float priority;
+        uint32_t node;
+
+    };
+
+    public:
+
+    static constexpr float k_zoneSize = 16.0f; // width and depth of a zone's block
+    static constexpr float k_zoneHeight = 4.0f; // height of a zone's band of floor
+    static constexpr int k_maxEntranceWidth = 6; // crossings per portal, at most
+    static constexpr uint32_t k_magic = 0x4856414E; // "NAVH"
+    static constexpr uint32_t k_version = 2;
+
+    NavHierarchy() = default;
+
+    // Replaces any previous contents
+    void build(const NavGraph & graph);
+
+    void clear();
+
+    bool empty() const { return m_zones.empty(); }
+
+    // Whether this was built from graph, as it is now
+    bool matches(const NavGraph & graph) const;
+
+    int nZones() const { return m_zonePortalOffsets.empty() ? 0 : int(m_zonePortalOffsets.size()) - 1; }
+    int nPortals() const { return int(m_portals.size()); }
+
+    uint32_t zone(uint32_t node) const { return m_zones[node]; }
+
+    // the number of nodes, of either level, the last search looked at
+    int nVisited() const { return m_nVisited; }
+
+    // A path from start to goal, where every edge costs 1. On success r_path
+    // is the nodes from start to goal inclusive. Crossing zones by their
+    // portals, it can be a little longer than the shortest
+    bool findPath(const NavGraph & graph, uint32_t start, uint32_t goal, Vector<uint32_t> & r_path);
+
+    // Versioned binary. Returns false on failure
+    bool write(const String & fileName) const;
+
+    // Returns false on failure, including a file of another version or one
+    // whose indices don't hold together, and leaves this empty
+    bool read(const String & fileName);
+
+    private:
+
+    // Deduces the lookups that aren't stored
+    void buildLookups();
+
+    // Breadth first search from node that doesn't leave its zone, following
+    // edges backwards if isReverse. Stops early on reaching target
+    bool searchZone(const NavGraph & graph, uint32_t from, uint32_t target, bool isReverse);
+
+    bool isZoneReached(uint32_t node) const { return m_zoneStamps[node] == m_zoneStamp; }
+
+    // appends the nodes after from on the way to target that searchZone found
+    void appendZonePath(uint32_t from, uint32_t target, Vector<uint32_t> & r_path);
+
+    // A* over the portals, from start to goal, into m_abstractPath
+    bool findAbstractPath(const NavGraph & graph, uint32_t start, uint32_t goal);
+
+    // the index of the edge between two portals
+    uint32_t findEdge(uint32_t from, uint32_t to) const;
+
+    // stored
+    Vector<uint32_t> m_zones; // zone of each node
+    Vector<uint32_t> m_portals; // node of each portal
+    Vector<uint32_t> m_offsets; // one more than there are portals
+    Vector<Edge> m_edges;
+    Vector<uint32_t> m_pathOffsets; // one more than there are edges
+    Vector<uint32_t> m_pathNodes; // of each edge, the nodes after its portal, up to and including its end
+    uint64_t m_graphHash = 0; // of the graph it was built from
+
+    // deduced
+    Vector<uint32_t> m_portalIs; // portal of each node, or NavGraph::k_invalid
+    Vector<uint32_t> m_zonePortalOffsets; // one more than there are zones
+    Vector<uint32_t> m_zonePortals; // portal indices, grouped by zone
+
+    // scratch
+    Vector<uint32_t> m_zoneDists;
+    Vector<uint32_t> m_zoneCameFrom;
+    Vector<uint32_t> m_zoneStamps; // a node's dist and cameFrom are only set this zone search if its stamp is m_zoneStamp
+    uint32_t m_zoneStamp = 0;
+    Vector<uint32_t> m_zoneQueue;
+    Vector<Edge> m_startEdges; // from start to the portals of its zone
+    Vector<Edge> m_goalEdges; // to goal from the portals of its zone, with to as the portal
+    Vector<float> m_costs; // per portal, then start, then goal
+    Vector<uint32_t> m_cameFrom;
+    Vector<uint32_t> m_stamps;
+    uint32_t m_stamp = 0;
+    Vector<OpenNode> m_open; // binary min heap
+    Vector<uint32_t> m_abstractPath; // portal indices, with start and goal after them
+    int m_nVisited = 0;
+
+};
@@ -2,6 +2,8 @@
 
 
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
 
 #include "glm/glm.hpp"
@@ -38,6 +40,9 @@ class Octree {
         Node * parent;
         uint8_t activeOs;
         uint8_t parentO;
+        // union of the layers of every element that has been within, so it
+        // may include layers no longer present
+        unsigned int layers;
 
         Node();
         Node(const glm::vec3 & center, float radius, Node * parent, uint8_t parentO);
@@ -49,11 +54,28 @@ class Octree {
 
     };
 
+    struct Entry {
+
+        Node * node;
+        AABox region;
+        unsigned int layers;
+
+        Entry() : node(nullptr), region(), layers(0) {}
+        Entry(Node * node, const AABox & region, unsigned int layers) : node(node), region(region), layers(layers) {}
+
+    };
+
     public:
 
+    // The kinds of queries whose node visits are counted, in the order of the
+    // filter overloads below
+    enum class Query { custom, region, ray, nearestRay, allRay, element };
+    static constexpr int k_nQueries = 6;
+
     Octree(const AABox & region, float minSize);
 
-    bool set(T e, const AABox & region);
+    // Layers are bit flags that queries can use to skip whole nodes
+    bool set(T e, const AABox & region, unsigned int layers = ~0u);
 
     bool remove(T e);
 
@@ -63,40 +85,66 @@ class Octree {
     // F takes the center and radius of a node and returns whether it should be included.
     size_t filter(const std::function<bool(const glm::vec3 &, float)> & f, Vector<T> & r_results) const;
     // Retrieves all elements within all nodes intersecting the given region.
-    size_t filter(const AABox & region, Vector<T> & r_results) const;
+    // Nodes without any elements in the given layers are skipped.
+    size_t filter(const AABox & region, Vector<T> & r_results, unsigned int layers = ~0u) const;
     // Retrieves all elements within all nodes intersecting the given ray.
     size_t filter(const Ray & ray, Vector<T> & r_results) const;
     // Retrieves the nearest element and intersection with the given ray.
     // F takes a ray and an element and returns an Intersect.
     // FAR more efficient than the above method when only the nearest element is desired.
-    std::pair<T, Intersect> filter(const Ray & ray, const std::function<Intersect(const Ray &, T)> & f) const;
+    std::pair<T, Intersect> filter(const Ray & ray, const std::function<Intersect(const Ray &, T)> & f, unsigned int layers = ~0u) const;
+    // Retrieves every element and intersection with the given ray within maxDist,
+    // sorted by distance, in a single traversal.
+    // F takes a ray and an element and returns an Intersect. Nothing beyond the
+    // nearest intersection whose element passes stop is retrieved, and that
+    // intersection is the last result.
+    size_t filter(
+        const Ray & ray, const std::function<Intersect(const Ray &, T)> & f, const std::function<bool(T)> & stop,
+        float maxDist, Vector<std::pair<T, Intersect>> & r_results, unsigned int layers = ~0u
+    ) const;
     // Retrieves all elements within all nodes intersecting the region of the given element.
-    size_t filter(T e, Vector<T> & r_results) const;
+    size_t filter(T e, Vector<T> & r_results, unsigned int layers = ~0u) const;
+
+    // The number of nodes visited by queries of the given kind since the last
+    // reset. Queries may count from multiple threads at once
+    int nVisits(Query query) const { return m_nVisits[int(query)]; }
+
+    void resetVisits();
 
     private:
 
-    bool addUp(Node & node, T e, const AABox & region);
-    void addDown(Node & node, T e, const AABox & region);
+    bool addUp(Node & node, T e, const AABox & region, unsigned int layers);
+    void addDown(Node & node, T e, const AABox & region, unsigned int layers);
+    void place(Node & node, T e, const AABox & region, unsigned int layers);
 
     void fragment(Node & node);
 
     void trim(Node & node);
     
-    size_t filter(const Node & node, const std::function<bool(const glm::vec3 &, float)> & f, Vector<T> & r_results) const;
-    size_t filter(const Node & node, const AABox & region, Vector<T> & r_results) const;
-    size_t filter(const Node & node, const Ray & ray, const glm::vec3 & invDir, Vector<T> & r_results) const;
+    // each adds the number of nodes it visits to r_nVisits
+    size_t filter(const Node & node, const std::function<bool(const glm::vec3 &, float)> & f, Vector<T> & r_results, int & r_nVisits) const;
+    size_t filter(const Node & node, const AABox & region, unsigned int layers, Vector<T> & r_results, int & r_nVisits) const;
+    size_t filter(const Node & node, const Ray & ray, const glm::vec3 & invDir, Vector<T> & r_results, int & r_nVisits) const;
     void filter(
         const Node & node, const Ray & ray, const std::function<Intersect(const Ray &, T)> & f,
-        const glm::vec3 & invDir, const glm::vec3 & signDir, float near, float far, const uint8_t * oMap,
-        T & r_elem, Intersect & r_inter
+        const glm::vec3 & invDir, const glm::vec3 & signDir, float near, float far, const uint8_t * oMap, unsigned int layers,
+        T & r_elem, Intersect & r_inter, int & r_nVisits
     ) const;
+    void filter(
+        const Node & node, const Ray & ray, const std::function<Intersect(const Ray &, T)> & f, const std::function<bool(T)> & stop,
+        const glm::vec3 & invDir, unsigned int layers, float & r_maxDist, Vector<std::pair<T, Intersect>> & r_results, int & r_nVisits
+    ) const;
+
+    // adds to the visit count of the query once it is done, rather than per node
+    void countVisits(Query query, int nVisits) const;
 
     private:
 
     UniquePtr<Node> m_root;
     AABox m_rootRegion;
     float m_minRadius;
-    UnorderedMap<T, std::pair<Node *, AABox>> m_map;
+    UnorderedMap<T, Entry> m_map;
+    mutable std::atomic<int> m_nVisits[k_nQueries];
 
 };
 
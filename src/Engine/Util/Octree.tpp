@@ -97,7 +97,8 @@ Octree<T>::Node::Node() :
     children(),
     parent(nullptr),
     activeOs(0),
-    parentO(0)
+    parentO(0),
+    layers(0)
 {}
 
 template <typename T>
@@ -108,7 +109,8 @@ Octree<T>::Node::Node(const glm::vec3 & center, float radius, Node * parent, uin
     children(),
     parent(parent),
     activeOs(0),
-    parentO(parentO)
+    parentO(parentO),
+    layers(0)
 {}
 
 
@@ -122,13 +124,14 @@ Octree<T>::Octree(const AABox & region, float minSize) {
     m_root = UniquePtr<Node>::make(region.center(), iSize * m_minRadius, nullptr, 0);
     m_rootRegion.min = m_root->center - m_root->radius;
     m_rootRegion.max = m_root->center + m_root->radius;
+    resetVisits();
 }
 
 template <typename T>
-bool Octree<T>::set(T e, const AABox & region) {
+bool Octree<T>::set(T e, const AABox & region, unsigned int layers) {
     auto it(m_map.find(e));
     if (it != m_map.end()) {
-        Node & node(*it->second.first);
+        Node & node(*it->second.node);
         m_map.erase(it);
         for (Util::nat i(node.elements.size() - 1); i >= 0; --i) {
             if (node.elements[i] == e) {
@@ -136,13 +139,13 @@ bool Octree<T>::set(T e, const AABox & region) {
                 break;
             }
         }
-        bool res(addUp(node, e, region));
+        bool res(addUp(node, e, region, layers));
         trim(node);
         return res;
     }
     else {
         if (detail::intersects(m_rootRegion, region)) {
-            addDown(*m_root, e, region);
+            addDown(*m_root, e, region, layers);
             return true;
         }
         return false;
@@ -156,7 +159,7 @@ bool Octree<T>::remove(T e) {
         return false;
     }
 
-    Node & node(*it->second.first);
+    Node & node(*it->second.node);
     for (Util::nat i(node.elements.size() - 1); i >= 0; --i) {
         if (node.elements[i] == e) {
             node.elements.erase(node.elements.begin() + i);
@@ -175,17 +178,30 @@ void Octree<T>::clear() {
     m_root->elements.clear();
     m_root->children.release();
     m_root->activeOs = 0;
+    m_root->layers = 0;
     m_map.clear();
 }
 
 template <typename T>
 size_t Octree<T>::filter(const std::function<bool(const glm::vec3 &, float)> & f, Vector<T> & r_results) const {
-    return f(m_root->center, m_root->radius) ? filter(*m_root, f, r_results) : 0;
+    if (!f(m_root->center, m_root->radius)) {
+        return 0;
+    }
+    int nVisits(0);
+    size_t n(filter(*m_root, f, r_results, nVisits));
+    countVisits(Query::custom, nVisits);
+    return n;
 }
 
 template <typename T>
-size_t Octree<T>::filter(const AABox & region, Vector<T> & r_results) const {
-    return detail::intersects(m_rootRegion, region) ? filter(*m_root, region, r_results) : 0;
+size_t Octree<T>::filter(const AABox & region, Vector<T> & r_results, unsigned int layers) const {
+    if (!detail::intersects(m_rootRegion, region)) {
+        return 0;
+    }
+    int nVisits(0);
+    size_t n(filter(*m_root, region, layers, r_results, nVisits));
+    countVisits(Query::region, nVisits);
+    return n;
 }
 
 template <typename T>
@@ -196,11 +212,17 @@ size_t Octree<T>::filter(const Ray & ray, Vector<T> & r_results) const {
         Util::isZero(ray.dir.z) ? Util::infinity() : 1.0f / ray.dir.z
     );
     float near, far;
-    return detail::intersect(ray, invDir, m_rootRegion.min, m_rootRegion.max, near, far) ? filter(*m_root, ray, invDir, r_results) : 0;
+    if (!detail::intersect(ray, invDir, m_rootRegion.min, m_rootRegion.max, near, far)) {
+        return 0;
+    }
+    int nVisits(0);
+    size_t n(filter(*m_root, ray, invDir, r_results, nVisits));
+    countVisits(Query::ray, nVisits);
+    return n;
 }
 
 template <typename T>
-std::pair<T, Intersect> Octree<T>::filter(const Ray & ray, const std::function<Intersect(const Ray &, T)> & f) const {
+std::pair<T, Intersect> Octree<T>::filter(const Ray & ray, const std::function<Intersect(const Ray &, T)> & f, unsigned int layers) const {
     glm::vec3 absDir(glm::abs(ray.dir));
     glm::vec3 invDir, signDir;
     if (Util::isZeroAbs(absDir.x)) {
@@ -287,45 +309,101 @@ std::pair<T, Intersect> Octree<T>::filter(const Ray & ray, const std::function<I
     }*/
 
     std::pair<T, Intersect> res{};
-    filter(*m_root, ray, f, invDir, signDir, near, far, reinterpret_cast<uint8_t *>(&oMap), res.first, res.second);
+    int nVisits(0);
+    filter(*m_root, ray, f, invDir, signDir, near, far, reinterpret_cast<uint8_t *>(&oMap), layers, res.first, res.second, nVisits);
+    countVisits(Query::nearestRay, nVisits);
     return res;
 }
 
 template <typename T>
-size_t Octree<T>::filter(T e, Vector<T> & r_results) const {
+size_t Octree<T>::filter(
+    const Ray & ray, const std::function<Intersect(const Ray &, T)> & f, const std::function<bool(T)> & stop,
+    float maxDist, Vector<std::pair<T, Intersect>> & r_results, unsigned int layers
+) const {
+    glm::vec3 invDir(
+        Util::isZero(ray.dir.x) ? Util::infinity() : 1.0f / ray.dir.x,
+        Util::isZero(ray.dir.y) ? Util::infinity() : 1.0f / ray.dir.y,
+        Util::isZero(ray.dir.z) ? Util::infinity() : 1.0f / ray.dir.z
+    );
+    float near, far;
+    if (!detail::intersect(ray, invDir, m_rootRegion.min, m_rootRegion.max, near, far) || near > maxDist) {
+        return 0;
+    }
+
+    size_t prevSize(r_results.size());
+    int nVisits(0);
+    filter(*m_root, ray, f, stop, invDir, layers, maxDist, r_results, nVisits);
+    countVisits(Query::allRay, nVisits);
+
+    auto begin(r_results.begin() + prevSize);
+    std::stable_sort(begin, r_results.end(), [](const std::pair<T, Intersect> & r1, const std::pair<T, Intersect> & r2) {
+        return r1.second.dist < r2.second.dist;
+    });
+    // anything found before the stopping intersection was known is discarded
+    for (auto it(begin); it != r_results.end(); ++it) {
+        if (it->second.dist > maxDist) {
+            r_results.erase(it, r_results.end());
+            break;
+        }
+        if (stop(it->first)) {
+            r_results.erase(it + 1, r_results.end());
+            break;
+        }
+    }
+
+    return r_results.size() - prevSize;
+}
+
+template <typename T>
+size_t Octree<T>::filter(T e, Vector<T> & r_results, unsigned int layers) const {
     auto it(m_map.find(e));
     if (it == m_map.end()) {
         return 0;
     }
 
     size_t n(0);
-    Node * node(it->second.first->parent);
+    int nVisits(0);
+    Node * node(it->second.node->parent);
     while (node) {
         n += node->elements.size();
         for (T e : node->elements) {
             r_results.push_back(e);
         }
         node = node->parent;
+        ++nVisits;
     }
 
-    return n + filter(*it->second.first, it->second.second, r_results);
+    n += filter(*it->second.node, it->second.region, layers, r_results, nVisits);
+    countVisits(Query::element, nVisits);
+    return n;
 }
 
 template <typename T>
-bool Octree<T>::addUp(Node & node, T e, const AABox & region) {
+void Octree<T>::resetVisits() {
+    for (std::atomic<int> & n : m_nVisits) {
+        n = 0;
+    }
+}
+
+template <typename T>
+void Octree<T>::countVisits(Query query, int nVisits) const {
+    m_nVisits[int(query)].fetch_add(nVisits, std::memory_order_relaxed);
+}
+
+template <typename T>
+bool Octree<T>::addUp(Node & node, T e, const AABox & region, unsigned int layers) {
     AABox nodeRegion(node.center - node.radius, node.center + node.radius);
     if (detail::contains(nodeRegion, region)) {
-        addDown(node, e, region);
+        addDown(node, e, region, layers);
         return true;
     }
     else {
         if (node.parent) {
-            return addUp(*node.parent, e, region);
+            return addUp(*node.parent, e, region, layers);
         }
         else {
             if (detail::intersects(nodeRegion, region)) {
-                node.elements.push_back(e);
-                m_map[e] = std::pair<Node *, AABox>(&node, region);
+                place(node, e, region, layers);
                 return true;
             }
             return false;
@@ -334,24 +412,23 @@ bool Octree<T>::addUp(Node & node, T e, const AABox & region) {
 }
 
 template <typename T>
-void Octree<T>::addDown(Node & node, T e, const AABox & region) {
+void Octree<T>::addDown(Node & node, T e, const AABox & region, unsigned int layers) {
     // The node is a leaf. Extra logic necessary
     if (!node.children) {
         // If the node is empty or at max depth, simply add to elements
         if (!node.elements.size() || Util::isLE(node.radius, m_minRadius)) {
-            node.elements.push_back(e);
-            m_map[e] = std::pair<Node *, AABox>(&node, region);
+            place(node, e, region, layers);
         }
         else {
             // If the node only has one element, it may not have been tried
             // to be put into a sub node. Try that now
             if (node.elements.size() == 1) {
                 T e_(node.elements.front());
-                const AABox & region_(m_map.at(e_).second);
-                int o(detail::detOctant(node.center, region_));
+                Entry entry_(m_map.at(e_));
+                int o(detail::detOctant(node.center, entry_.region));
                 if (o >= 0) {
                     fragment(node);
-                    addDown(node.children[o], e_, region_);
+                    addDown(node.children[o], e_, entry_.region, entry_.layers);
                     node.activeOs |= 1 << o;
                     node.elements.clear();       
                 }
@@ -360,12 +437,11 @@ void Octree<T>::addDown(Node & node, T e, const AABox & region) {
             int o(detail::detOctant(node.center, region));
             if (o >= 0) {
                 if (!node.children) fragment(node);
-                addDown(node.children[o], e, region);
+                addDown(node.children[o], e, region, layers);
                 node.activeOs |= 1 << o;
             }
             else {
-                node.elements.push_back(e);
-                m_map[e] = std::pair<Node *, AABox>(&node, region);
+                place(node, e, region, layers);
             }
         }
     }
@@ -373,16 +449,24 @@ void Octree<T>::addDown(Node & node, T e, const AABox & region) {
     else {
         int o(detail::detOctant(node.center, region));
         if (o >= 0) {
-            addDown(node.children[o], e, region);
+            addDown(node.children[o], e, region, layers);
             node.activeOs |= 1 << o;
         }
         else {
-            node.elements.push_back(e);
-            m_map[e] = std::pair<Node *, AABox>(&node, region);
+            place(node, e, region, layers);
         }
     }
 }
 
+template <typename T>
+void Octree<T>::place(Node & node, T e, const AABox & region, unsigned int layers) {
+    node.elements.push_back(e);
+    m_map[e] = Entry(&node, region, layers);
+    for (Node * n(&node); n && (n->layers & layers) != layers; n = n->parent) {
+        n->layers |= layers;
+    }
+}
+
 template <typename T>
 void Octree<T>::fragment(Node & node) {
     node.children = UniquePtr<Node[]>::make(8);
@@ -423,7 +507,8 @@ void Octree<T>::trim(Node & node_) {
 }
 
 template <typename T>
-size_t Octree<T>::filter(const Node & node, const std::function<bool(const glm::vec3 &, float)> & f, Vector<T> & r_results) const {
+size_t Octree<T>::filter(const Node & node, const std::function<bool(const glm::vec3 &, float)> & f, Vector<T> & r_results, int & r_nVisits) const {
+    ++r_nVisits;
     size_t n(node.elements.size());
     for (T e : node.elements) {
         r_results.push_back(e);
@@ -431,7 +516,7 @@ size_t Octree<T>::filter(const Node & node, const std::function<bool(const glm::
     if (node.children) {
         for (int o(0); o < 8; ++o) {
             if (node.activeOs & (1 << o) && f(node.children[o].center, node.children[o].radius)) {
-                n += filter(node.children[o], f, r_results);
+                n += filter(node.children[o], f, r_results, r_nVisits);
             }
         }
     }
@@ -439,8 +524,9 @@ size_t Octree<T>::filter(const Node & node, const std::function<bool(const glm::
 }
 
 template <typename T>
-size_t Octree<T>::filter(const Node & node, const AABox & region, Vector<T> & r_results) const {
-    size_t n(node.elements.size());    
+size_t Octree<T>::filter(const Node & node, const AABox & region, unsigned int layers, Vector<T> & r_results, int & r_nVisits) const {
+    ++r_nVisits;
+    size_t n(node.elements.size());
     for (T e : node.elements) {
         r_results.push_back(e);
     }
@@ -454,8 +540,8 @@ size_t Octree<T>::filter(const Node & node, const AABox & region, Vector<T> & r_
         if (region.max.x <= node.center.x) possible &= 0x55;
         if (region.min.x >= node.center.x) possible &= 0xAA;
         for (int o(0); o < 8; ++o) {
-            if (possible & (1 << o)) {
-                n += filter(node.children[o], region, r_results);
+            if (possible & (1 << o) && node.children[o].layers & layers) {
+                n += filter(node.children[o], region, layers, r_results, r_nVisits);
             }
         }
     }
@@ -464,8 +550,9 @@ size_t Octree<T>::filter(const Node & node, const AABox & region, Vector<T> & r_
 }
 
 template <typename T>
-size_t Octree<T>::filter(const Node & node, const Ray & ray, const glm::vec3 & invDir, Vector<T> & r_results) const {
-    size_t n(node.elements.size());    
+size_t Octree<T>::filter(const Node & node, const Ray & ray, const glm::vec3 & invDir, Vector<T> & r_results, int & r_nVisits) const {
+    ++r_nVisits;
+    size_t n(node.elements.size());
     for (const T & e : node.elements) {
         r_results.push_back(e);
     }
@@ -476,7 +563,7 @@ size_t Octree<T>::filter(const Node & node, const Ray & ray, const glm::vec3 & i
                 const Node & child(node.children[o]);
                 float near, far;
                 if (detail::intersect(ray, invDir, child.center - child.radius, child.center + child.radius, near, far)) {
-                    n += filter(child, ray, invDir, r_results);
+                    n += filter(child, ray, invDir, r_results, r_nVisits);
                 }
             }
         }
@@ -486,7 +573,8 @@ size_t Octree<T>::filter(const Node & node, const Ray & ray, const glm::vec3 & i
 }
 
 template <typename T>
-void Octree<T>::filter(const Node & node, const Ray & ray, const std::function<Intersect(const Ray &, T)> & f, const glm::vec3 & invDir, const glm::vec3 & signDir, float near_, float far_, const uint8_t * oMap, T & r_elem, Intersect & r_inter) const {
+void Octree<T>::filter(const Node & node, const Ray & ray, const std::function<Intersect(const Ray &, T)> & f, const glm::vec3 & invDir, const glm::vec3 & signDir, float near_, float far_, const uint8_t * oMap, unsigned int layers, T & r_elem, Intersect & r_inter, int & r_nVisits) const {
+    ++r_nVisits;
     for (T e : node.elements) {
         Intersect potential(f(ray, e));
         if (potential.dist < r_inter.dist) {
@@ -518,10 +606,10 @@ void Octree<T>::filter(const Node & node, const Ray & ray, const std::function<I
             break; // A closer intersection has already been found. No need to continue
         }
 
-        if (node.activeOs & (1 << oMap[o])) {
+        if (node.activeOs & (1 << oMap[o]) && node.children[oMap[o]].layers & layers) {
             Intersect potential;
             T elem;
-            filter(node.children[oMap[o]], ray, f, invDir, signDir, near, far, oMap, elem, potential);
+            filter(node.children[oMap[o]], ray, f, invDir, signDir, near, far, oMap, layers, elem, potential, r_nVisits);
             if (potential.dist < r_inter.dist) {
                 r_inter = potential;
                 r_elem = elem;
@@ -563,3 +651,50 @@ void Octree<T>::filter(const Node & node, const Ray & ray, const std::function<I
         }
     }
 }
+
+template <typename T>
+void Octree<T>::filter(
+    const Node & node, const Ray & ray, const std::function<Intersect(const Ray &, T)> & f, const std::function<bool(T)> & stop,
+    const glm::vec3 & invDir, unsigned int layers, float & r_maxDist, Vector<std::pair<T, Intersect>> & r_results, int & r_nVisits
+) const {
+    ++r_nVisits;
+    for (T e : node.elements) {
+        Intersect inter(f(ray, e));
+        if (inter.is && inter.dist <= r_maxDist) {
+            r_results.emplace_back(e, inter);
+            if (stop(e)) {
+                r_maxDist = inter.dist;
+            }
+        }
+    }
+
+    if (!node.children) {
+        return;
+    }
+
+    // visit children nearest first so that a stopping intersection prunes as much as possible
+    int os[8];
+    float nears[8];
+    int nChildren(0);
+    for (int o(0); o < 8; ++o) {
+        if (node.activeOs & (1 << o) && node.children[o].layers & layers) {
+            const Node & child(node.children[o]);
+            float near, far;
+            if (detail::intersect(ray, invDir, child.center - child.radius, child.center + child.radius, near, far) && near <= r_maxDist) {
+                int i(nChildren++);
+                for (; i > 0 && nears[i - 1] > near; --i) {
+                    os[i] = os[i - 1];
+                    nears[i] = nears[i - 1];
+                }
+                os[i] = o;
+                nears[i] = near;
+            }
+        }
+    }
+    for (int i(0); i < nChildren; ++i) {
+        if (nears[i] > r_maxDist) {
+            break;
+        }
+        filter(node.children[os[i]], ray, f, stop, invDir, layers, r_maxDist, r_results, r_nVisits);
+    }
+}
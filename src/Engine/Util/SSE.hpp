@@ -0,0 +1,37 @@
+#pragma once
+
+
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define UTIL_SSE
+#include <emmintrin.h>
+#endif
+
+
+
+#ifdef UTIL_SSE
+
+// Four-wide helpers shared by the kernels that work on one value per lane
+namespace SSE {
+
+inline __m128 clamp4(__m128 v, __m128 lo, __m128 hi) {
+    return _mm_min_ps(_mm_max_ps(v, lo), hi);
+}
+
+inline __m128 length2_4(__m128 x, __m128 y, __m128 z) {
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+}
+
+// per lane, mask ? a : b
+inline __m128 select4(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// the mask's bits for the first n lanes
+inline int laneMask(__m128 mask, int n) {
+    return _mm_movemask_ps(mask) & ((1 << n) - 1);
+}
+
+}
+
+#endif
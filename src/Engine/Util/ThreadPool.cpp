@@ -0,0 +1,123 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+#ifdef USE_RPMALLOC
+#include "ThirdParty/CoherentLabs_rpmalloc/rpmalloc.h"
+#endif
+
+
+
+ThreadPool::ThreadPool(int nThreads) :
+    m_workers(),
+    m_mutex(),
+    m_startCV(),
+    m_doneCV(),
+    m_f(nullptr),
+    m_n(0),
+    m_chunkSize(0),
+    m_nChunks(0),
+    m_nextChunk(0),
+    m_generation(0),
+    m_nFinished(0),
+    m_isQuitting(false)
+{
+    if (nThreads <= 0) {
+        nThreads = std::max(int(std::thread::hardware_concurrency()), 1);
+    }
+    m_workers.reserve(nThreads - 1);
+    for (int i(1); i < nThreads; ++i) {
+        m_workers.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isQuitting = true;
+    }
+    m_startCV.notify_all();
+    for (std::thread & worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallelFor(int n, int minChunk, const std::function<void(int, int)> & f) {
+    if (n <= 0) {
+        return;
+    }
+
+    int nChunks(this->nChunks(n, minChunk));
+    int chunkSize((n + nChunks - 1) / nChunks);
+    nChunks = (n + chunkSize - 1) / chunkSize;
+
+    // not worth waking the workers
+    if (nChunks == 1) {
+        f(0, n);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_f = &f;
+        m_n = n;
+        m_chunkSize = chunkSize;
+        m_nChunks = nChunks;
+        m_nextChunk = 0;
+        m_nFinished = 0;
+        ++m_generation;
+    }
+    m_startCV.notify_all();
+
+    runChunks(f, n, chunkSize, nChunks);
+
+    // wait for every worker to be done with this job so the next can't be mixed with it
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCV.wait(lock, [&]() { return m_nFinished == int(m_workers.size()); });
+    m_f = nullptr;
+}
+
+int ThreadPool::nChunks(int n, int minChunk) const {
+    int maxChunks(std::max(n / std::max(minChunk, 1), 1));
+    // a few chunks per thread to even out uneven work
+    return std::min(maxChunks, nThreads() * 4);
+}
+
+void ThreadPool::work() {
+#ifdef USE_RPMALLOC
+    coherent_rpmalloc::rpmalloc_thread_initialize();
+#endif
+
+    unsigned int generation(0);
+    while (true) {
+        const std::function<void(int, int)> * f;
+        int n, chunkSize, nChunks;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_startCV.wait(lock, [&]() { return m_isQuitting || m_generation != generation; });
+            if (m_isQuitting) {
+                return;
+            }
+            generation = m_generation;
+            f = m_f;
+            n = m_n;
+            chunkSize = m_chunkSize;
+            nChunks = m_nChunks;
+        }
+
+        runChunks(*f, n, chunkSize, nChunks);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_nFinished;
+        }
+        m_doneCV.notify_one();
+    }
+}
+
+void ThreadPool::runChunks(const std::function<void(int, int)> & f, int n, int chunkSize, int nChunks) {
+    int c;
+    while ((c = m_nextChunk++) < nChunks) {
+        f(c * chunkSize, std::min((c + 1) * chunkSize, n));
+    }
+}
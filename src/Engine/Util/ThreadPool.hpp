@@ -0,0 +1,61 @@
+#pragma once
+
+
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "Memory.hpp"
+
+
+
+// A fixed set of worker threads that split ranges of work with the calling thread
+class ThreadPool {
+
+    public:
+
+    // nThreads includes the calling thread. If 0, uses the hardware concurrency
+    explicit ThreadPool(int nThreads = 0);
+    ThreadPool(const ThreadPool & other) = delete;
+    ThreadPool(ThreadPool && other) = delete;
+
+    ~ThreadPool();
+
+    ThreadPool & operator=(const ThreadPool & other) = delete;
+    ThreadPool & operator=(ThreadPool && other) = delete;
+
+    // Splits [0, n) into contiguous chunks of at least minChunk elements and
+    // calls f with the begin and end of each, across the worker threads and the
+    // calling thread. Chunk c always covers the same range for a given n, so
+    // results written per chunk can be merged in a deterministic order.
+    // Returns once every chunk is done. Not reentrant
+    void parallelFor(int n, int minChunk, const std::function<void(int, int)> & f);
+
+    // the number of chunks parallelFor will split n elements into
+    int nChunks(int n, int minChunk) const;
+
+    int nThreads() const { return int(m_workers.size()) + 1; }
+
+    private:
+
+    void work();
+    void runChunks(const std::function<void(int, int)> & f, int n, int chunkSize, int nChunks);
+
+    Vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_startCV;
+    std::condition_variable m_doneCV;
+    // current job, only changed while all workers are idle
+    const std::function<void(int, int)> * m_f;
+    int m_n;
+    int m_chunkSize;
+    int m_nChunks;
+    std::atomic<int> m_nextChunk;
+    unsigned int m_generation;
+    int m_nFinished;
+    bool m_isQuitting;
+
+};
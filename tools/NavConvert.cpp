@@ -0,0 +1,110 @@
+// Converts a nav graph from the text format MapExploreComponent writes to the
+// binary .nav format, and builds the .zones file kept alongside it, so that
+// the game needn't parse or build either on loading. Both are written next to
+// the text file by default, which is where PathfindingSystem looks for them.
+// Then a route across the whole graph is searched for both node by node and
+// by way of the zones, to show how much of the graph each looks at
+//
+// usage: NavConvert [graph txt] [nav out] [zones out]
+
+
+
+#include <chrono>
+#include <cstdio>
+
+#include "Util/NavGraph.hpp"
+#include "Util/NavHierarchy.hpp"
+
+
+
+namespace {
+
+// the reached node the most edges from node
+uint32_t furthestFrom(const NavGraph & graph, uint32_t node) {
+    NavField field;
+    field.build(graph, node);
+    uint32_t furthest(node);
+    for (uint32_t i(0); i < uint32_t(graph.nNodes()); ++i) {
+        if (field.distance(i) != NavField::k_unreached && field.distance(i) > field.distance(furthest)) {
+            furthest = i;
+        }
+    }
+    return furthest;
+}
+
+double msSince(std::chrono::high_resolution_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+}
+
+
+
+int main(int argc, char ** argv) {
+    String textPath(argc > 1 ? argv[1] : "../resources/smallMap.txt");
+    String navPath(argc > 2 ? String(argv[2]) : NavGraph::withExtension(textPath, ".nav"));
+    String zonesPath(argc > 3 ? String(argv[3]) : NavGraph::withExtension(textPath, ".zones"));
+
+    NavGraph graph;
+    auto start(std::chrono::high_resolution_clock::now());
+    if (!graph.readText(textPath)) {
+        std::fprintf(stderr, "failed to read %s\n", textPath.c_str());
+        return 1;
+    }
+    double textMs(msSince(start));
+
+    if (!graph.write(navPath)) {
+        std::fprintf(stderr, "failed to write %s\n", navPath.c_str());
+        return 1;
+    }
+    NavHierarchy hierarchy;
+    hierarchy.build(graph);
+    if (!hierarchy.write(zonesPath)) {
+        std::fprintf(stderr, "failed to write %s\n", zonesPath.c_str());
+        return 1;
+    }
+
+    // read back what was written, both to check it and to time it
+    NavGraph binaryGraph;
+    start = std::chrono::high_resolution_clock::now();
+    if (!binaryGraph.read(navPath) || binaryGraph.hash() != graph.hash() || !binaryGraph.isFromText(textPath)) {
+        std::fprintf(stderr, "failed to read back %s\n", navPath.c_str());
+        return 1;
+    }
+    double binaryMs(msSince(start));
+    NavHierarchy binaryHierarchy;
+    if (!binaryHierarchy.read(zonesPath) || !binaryHierarchy.matches(binaryGraph)) {
+        std::fprintf(stderr, "failed to read back %s\n", zonesPath.c_str());
+        return 1;
+    }
+
+    std::printf(
+        "%d nodes, %d edges, %d zones, %d portals: text %.3f ms, binary %.3f ms\n",
+        graph.nNodes(), graph.nEdges(), hierarchy.nZones(), hierarchy.nPortals(),
+        textMs, binaryMs
+    );
+
+    // the field runs back along edges, so the start is the furthest node
+    // that can reach the goal, which makes for about the longest route there is
+    if (graph.empty()) {
+        return 0;
+    }
+    uint32_t goalNode(furthestFrom(binaryGraph, 0));
+    uint32_t startNode(furthestFrom(binaryGraph, goalNode));
+    Vector<uint32_t> path;
+    NavSearch search;
+    start = std::chrono::high_resolution_clock::now();
+    bool isFound(search.findPath(binaryGraph, startNode, goalNode, path));
+    double searchMs(msSince(start));
+    int length(int(path.size()));
+    start = std::chrono::high_resolution_clock::now();
+    bool isZoneFound(binaryHierarchy.findPath(binaryGraph, startNode, goalNode, path));
+    double zoneSearchMs(msSince(start));
+    std::printf(
+        "route from node %u to %u: node by node %s, %d nodes long, %d visited, %.3f ms; by zones %s, %d nodes long, %d visited, %.3f ms\n",
+        startNode, goalNode,
+        isFound ? "found" : "not found", length, search.nVisited(), searchMs,
+        isZoneFound ? "found" : "not found", int(path.size()), binaryHierarchy.nVisited(), zoneSearchMs
+    );
+    return 0;
+}